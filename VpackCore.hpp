@@ -7,15 +7,33 @@
 #define VPACKCORE_VPACKCORE_HPP
 
 #include "src/optional.hpp"
+#include "src/compact_optional.hpp"
+#include "src/intrusive_pointer.hpp"
 #include "src/types.hpp"
+#include "src/affine.hpp"
+#include "src/fixed_point.hpp"
+#include "src/interned_identifier.hpp"
 
 #include "src/layout_result.hpp"
+#include "src/layout_context.hpp"
+#include "src/measure_cache.hpp"
+#include "src/executor.hpp"
+#include "src/task.hpp"
+#include "src/placement.hpp"
+#include "src/resizable_layout.hpp"
+#include "src/parametric_layout.hpp"
 #include "src/computer.hpp"
+#include "src/layout_job.hpp"
+#include "src/pipelined_layout.hpp"
+#include "src/layout_program.hpp"
+#include "src/pixel_snapping.hpp"
 
 #include "src/layoutables/item.hpp"
 #include "src/layoutables/containers/horizontal_container.hpp"
 #include "src/layoutables/containers/vertical_container.hpp"
 #include "src/layoutables/containers/stack_container.hpp"
 #include "src/layoutables/containers/decorated_container.hpp"
+#include "src/layoutables/containers/container_builder.hpp"
+#include "src/layoutables/node_dispatch.hpp"
 
 #endif //VPACKCORE_VPACKCORE_HPP
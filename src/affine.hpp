@@ -0,0 +1,265 @@
+//
+// Created by ktiays on 2022/9/15.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_AFFINE_HPP
+#define VPACKCORE_AFFINE_HPP
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include "types.hpp"
+
+namespace vpk::core {
+
+/// A value that changes linearly with the width and the height of the root frame of a layout.
+///
+/// The value is known at the frame the layout has been computed in, together with its rates of change,
+/// so it can be evaluated for a nearby frame with two multiply-adds.
+template<typename ValueType>
+struct Affine {
+    /// The value at the frame the layout has been computed in.
+    ValueType value;
+    /// The change of the value per unit of width of the root frame.
+    ValueType dw;
+    /// The change of the value per unit of height of the root frame.
+    ValueType dh;
+
+    constexpr Affine()
+        : value(0), dw(0), dh(0) {}
+
+    /// A value that does not depend on the root frame.
+    constexpr Affine(ValueType value)
+        : value(value), dw(0), dh(0) {}
+
+    /// A constant from a literal, e.g. `0`, which a value type that is a class may only convert to implicitly.
+    template<typename T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, ValueType>, int> = 0>
+    constexpr Affine(T value)
+        : Affine(ValueType(value)) {}
+
+    constexpr Affine(ValueType value, ValueType dw, ValueType dh)
+        : value(value), dw(dw), dh(dh) {}
+
+    inline bool constant() const { return dw == 0 && dh == 0; }
+
+    /// The value when the root frame is larger by the specified amounts.
+    inline ValueType at(ValueType width_delta, ValueType height_delta) const {
+        // Constants are evaluated exactly, which keeps infinite values from turning into NaN.
+        if (constant()) return value;
+        return value + dw * width_delta + dh * height_delta;
+    }
+
+    Affine& operator +=(const Affine& other) {
+        value += other.value;
+        dw += other.dw;
+        dh += other.dh;
+        return *this;
+    }
+
+    Affine& operator -=(const Affine& other) {
+        value -= other.value;
+        dw -= other.dw;
+        dh -= other.dh;
+        return *this;
+    }
+
+    Affine& operator *=(ValueType factor) {
+        value *= factor;
+        dw *= factor;
+        dh *= factor;
+        return *this;
+    }
+
+    Affine& operator /=(ValueType divisor) {
+        value /= divisor;
+        dw /= divisor;
+        dh /= divisor;
+        return *this;
+    }
+
+    friend Affine operator +(Affine a, const Affine& b) { return a += b; }
+
+    friend Affine operator -(Affine a, const Affine& b) { return a -= b; }
+
+    friend Affine operator -(const Affine& a) { return { -a.value, -a.dw, -a.dh }; }
+
+    friend Affine operator *(Affine a, ValueType factor) { return a *= factor; }
+
+    friend Affine operator /(Affine a, ValueType divisor) { return a /= divisor; }
+};
+
+/// The ranges of root frame sizes within which a layout keeps its structure, i.e. every frame
+/// of the layout is an affine function of the root frame size.
+template<typename ValueType>
+struct LayoutValidity {
+    Range<ValueType> width;
+    Range<ValueType> height;
+
+    inline bool contains(const Size<ValueType>& size) const {
+        return width.contains(size.width) && height.contains(size.height);
+    }
+};
+
+namespace detail {
+
+/// Collects the conditions on the root frame size under which the comparisons of an affine layout
+/// pass keep their outcomes.
+///
+/// The conditions are reduced to a box of sizes around the frame the layout has been computed in. A condition
+/// that depends on both the width and the height is split, each dimension may use half of its slack.
+template<typename ValueType>
+class AffineConstraints {
+public:
+    /// Installs the constraints for the current thread during the lifetime of the scope.
+    class Scope {
+    public:
+        explicit Scope(AffineConstraints& constraints)
+            : previous_(current_) {
+            current_ = &constraints;
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator =(const Scope&) = delete;
+
+        ~Scope() { current_ = previous_; }
+
+    private:
+        AffineConstraints* previous_;
+    };
+
+    static inline AffineConstraints* current() { return current_; }
+
+    /// Requires the value to stay non-negative.
+    ///
+    /// Conditions that require a positive value are recorded as non-negative ones. They only differ at their bound,
+    /// where the compared values are equal.
+    void require_non_negative(const Affine<ValueType>& value) {
+        using std::isinf;
+        if (value.constant() || isinf(value.value)) return;
+        if (value.dw != 0 && value.dh != 0) {
+            bound(width_delta_, value.value / 2, value.dw);
+            bound(height_delta_, value.value / 2, value.dh);
+        } else if (value.dw != 0) {
+            bound(width_delta_, value.value, value.dw);
+        } else {
+            bound(height_delta_, value.value, value.dh);
+        }
+    }
+
+    /// The sizes of the root frame for which all conditions hold, up to the rounding of the compared values.
+    ///
+    /// \param size The size of the root frame the layout has been computed in, which is always contained.
+    LayoutValidity<ValueType> validity(const Size<ValueType>& size) const {
+        return { range(size.width, width_delta_), range(size.height, height_delta_) };
+    }
+
+private:
+    static inline thread_local AffineConstraints* current_ = nullptr;
+
+    Range<ValueType> width_delta_ = Range<ValueType>::unbounded();
+    Range<ValueType> height_delta_ = Range<ValueType>::unbounded();
+
+    /// Restricts the delta so that `value + slope * delta` stays non-negative.
+    static void bound(Range<ValueType>& delta, ValueType value, ValueType slope) {
+        const ValueType limit = -value / slope;
+        if (slope > 0) {
+            delta.lower = std::max(delta.lower, limit);
+        } else {
+            delta.upper = std::min(delta.upper, limit);
+        }
+    }
+
+    static Range<ValueType> range(ValueType value, const Range<ValueType>& delta) {
+        // The upper bound is exclusive, but the value the layout has been computed for is valid even when
+        // a condition leaves no slack.
+        const ValueType lower = std::min(value, value + delta.lower);
+        ValueType upper = value + delta.upper;
+        using std::nextafter;
+        if (!(upper > value)) upper = nextafter(value, std::numeric_limits<ValueType>::infinity());
+        return { lower, upper };
+    }
+};
+
+/// Compares values for `min` and `max`.
+template<typename T>
+struct Ordering {
+    static inline const T& min(const T& a, const T& b) { return std::min(a, b); }
+
+    static inline const T& max(const T& a, const T& b) { return std::max(a, b); }
+};
+
+/// Compares affine values by their values at the frame the layout has been computed in, and records
+/// the conditions under which the comparisons keep their outcomes.
+///
+/// Equal values are ordered by their rates of change, so the outcome holds for slightly larger frames as well,
+/// which matches the ranges of sizes that include their lower bounds.
+template<typename ValueType>
+struct Ordering<Affine<ValueType>> {
+    static Affine<ValueType> min(const Affine<ValueType>& a, const Affine<ValueType>& b) {
+        if (less(b, a)) {
+            require_order(b, a);
+            return b;
+        }
+        require_order(a, b);
+        return a;
+    }
+
+    static Affine<ValueType> max(const Affine<ValueType>& a, const Affine<ValueType>& b) {
+        if (less(a, b)) {
+            require_order(a, b);
+            return b;
+        }
+        require_order(b, a);
+        return a;
+    }
+
+private:
+    static inline bool less(const Affine<ValueType>& a, const Affine<ValueType>& b) {
+        if (a.value != b.value) return a.value < b.value;
+        if (a.dw != b.dw) return a.dw < b.dw;
+        return a.dh < b.dh;
+    }
+
+    /// Requires the lower value to stay below the upper value.
+    static void require_order(const Affine<ValueType>& lower, const Affine<ValueType>& upper) {
+        AffineConstraints<ValueType>* constraints = AffineConstraints<ValueType>::current();
+        if (constraints) constraints->require_non_negative(upper - lower);
+    }
+};
+
+/// The minimum of two values of the specified type, see `max`.
+template<typename T>
+inline T min(const std::type_identity_t<T>& a, const std::type_identity_t<T>& b) {
+    return Ordering<T>::min(a, b);
+}
+
+/// The maximum of two values of the specified type.
+///
+/// Code that runs in affine layout passes compares values with these functions instead of the ones of the standard
+/// library, so the comparisons of an affine pass record the conditions under which they keep their outcomes.
+template<typename T>
+inline T max(const std::type_identity_t<T>& a, const std::type_identity_t<T>& b) {
+    return Ordering<T>::max(a, b);
+}
+
+/// Requires the value to stay within the range.
+template<typename ValueType>
+void require_in_range(const Affine<ValueType>& value, const Range<ValueType>& range) {
+    AffineConstraints<ValueType>* constraints = AffineConstraints<ValueType>::current();
+    if (!constraints) return;
+    // Unqualified, so that value types other than the floating-point types provide their own.
+    using std::isinf;
+    if (!isinf(range.lower)) constraints->require_non_negative(value - range.lower);
+    // The upper bound is exclusive, but a degenerate range contains it.
+    if (!isinf(range.upper)) constraints->require_non_negative(-(value - range.upper));
+}
+
+}
+
+}
+
+#endif //VPACKCORE_AFFINE_HPP
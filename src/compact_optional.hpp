@@ -0,0 +1,94 @@
+//
+// Created by ktiays on 2022/9/16.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_COMPACT_OPTIONAL_HPP
+#define VPACKCORE_COMPACT_OPTIONAL_HPP
+
+#include <limits>
+#include <cassert>
+#include <type_traits>
+
+#include "optional.hpp"
+
+namespace vpk::core {
+
+/// Describes the value that marks an empty `CompactOptional`.
+///
+/// Types with a quiet NaN use it, other types use their lowest value. Specialize this for types where
+/// neither is available or the lowest value is meaningful.
+template<typename T>
+struct CompactOptionalTraits {
+    static constexpr T empty_value() {
+        if constexpr (std::numeric_limits<T>::has_quiet_NaN) return std::numeric_limits<T>::quiet_NaN();
+        else return std::numeric_limits<T>::lowest();
+    }
+
+    static constexpr bool is_empty(const T& value) {
+        // NaN is the only value that is not equal to itself.
+        if constexpr (std::numeric_limits<T>::has_quiet_NaN) return value != value;
+        else return value == std::numeric_limits<T>::lowest();
+    }
+};
+
+/// An optional value that takes no more space than the value, by reserving one value of the type
+/// for the empty state, see `CompactOptionalTraits`.
+///
+/// The reserved value cannot be stored, e.g. a compact optional of a floating-point type never holds NaN.
+template<typename T, typename Traits = CompactOptionalTraits<T>>
+class CompactOptional {
+    /// The type of `nullopt`, which depends on the implementation of `optional`.
+    using nullopt_t = std::decay_t<decltype(nullopt)>;
+
+public:
+    constexpr CompactOptional() noexcept
+        : value_(Traits::empty_value()) {}
+
+    constexpr CompactOptional(nullopt_t) noexcept
+        : CompactOptional() {}
+
+    constexpr CompactOptional(T value) noexcept
+        : value_(value) {
+        assert(!Traits::is_empty(value));
+    }
+
+    CompactOptional(const optional<T>& value) noexcept
+        : value_(value.has_value() ? *value : Traits::empty_value()) {}
+
+    constexpr CompactOptional& operator =(nullopt_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    constexpr bool has_value() const noexcept { return !Traits::is_empty(value_); }
+
+    constexpr explicit operator bool() const noexcept { return has_value(); }
+
+    constexpr const T& operator *() const noexcept {
+        assert(has_value());
+        return value_;
+    }
+
+    constexpr T value_or(T default_value) const noexcept { return has_value() ? value_ : default_value; }
+
+    constexpr void reset() noexcept { value_ = Traits::empty_value(); }
+
+    operator optional<T>() const {
+        if (has_value()) return value_;
+        return nullopt;
+    }
+
+    constexpr bool operator ==(const CompactOptional& other) const noexcept {
+        return has_value() ? other.has_value() && value_ == other.value_ : !other.has_value();
+    }
+
+    constexpr bool operator !=(const CompactOptional& other) const noexcept { return !(*this == other); }
+
+private:
+    T value_;
+};
+
+}
+
+#endif //VPACKCORE_COMPACT_OPTIONAL_HPP
@@ -6,48 +6,324 @@
 #ifndef VPACKCORE_COMPUTER_HPP
 #define VPACKCORE_COMPUTER_HPP
 
+#include <vector>
 #include <algorithm>
 
+#include "task.hpp"
+#include "placement.hpp"
+#include "layout_context.hpp"
+#include "resizable_layout.hpp"
+#include "parametric_layout.hpp"
 #include "layoutables/layoutable.hpp"
+#include "layoutables/node_dispatch.hpp"
+
+namespace vpk::core::detail {
+
+/// Measures the root element of a layout in the specified frame.
+template<typename Identifier, typename ValueType>
+Size<ValueType> measure_root(Layoutable<Identifier, ValueType>& item, const Rect<ValueType>& frame) {
+    const EdgeInsets<ValueType> padding = item.padding();
+    const Size<ValueType> size = item.measure(item.preferred_size(
+        { frame.width - padding.horizontal(), frame.height - padding.vertical() }
+    ));
+    return item.preferred_size(size);
+}
+
+/// Returns the frame of the root element of a layout with the measured size.
+template<typename Identifier, typename ValueType, typename Scalar>
+Rect<Scalar> root_frame(const Layoutable<Identifier, ValueType>& item, const Rect<Scalar>& frame,
+                        const Size<Scalar>& size) {
+    const EdgeInsets<ValueType> padding = item.padding();
+    const Point<ValueType> offset = item.offset();
+    return {
+        (frame.width - size.width) / 2 + padding.left + offset.x,
+        (frame.height - size.height) / 2 + padding.top + offset.y,
+        size.width - padding.horizontal(),
+        size.height - padding.vertical(),
+    };
+}
+
+}
 
 namespace vpk::core {
 
+template<typename Identifier, typename ValueType>
+class IncrementalLayout;
+
 template<typename Identifier, typename ValueType>
 class LayoutComputer {
 public:
     LayoutComputer(LayoutablePointer<Identifier, ValueType> it)
-        : item(it) {}
+        : item(it) {
+        item->resolve_node_kind();
+    }
 
+    /// Computes the layout of the element in the specified frame.
+    ///
+    /// The layout measures in a new measure pass (see `LayoutContext::begin_measure_pass`), so it reflects
+    /// the current content of the measurables.
+    /// If the context installed on the current thread interrupts the layout, the returned result is incomplete.
     LayoutResult<Identifier, ValueType> compute(const Rect<ValueType>& frame) const;
 
+    /// Computes the layout of the element in the specified frame, placing large subtrees on the executor.
+    ///
+    /// The measurement runs on the calling thread, only the placement is split into tasks,
+    /// see `detail::ParallelPlacement`. The result is the same as the result of `compute`.
+    LayoutResult<Identifier, ValueType> compute_parallel(const Rect<ValueType>& frame, Executor* executor,
+                                                         const ParallelPlacementOptions& options = {}) const;
+
+    /// Computes the layout of the element in the specified frame, measuring asynchronous measurables concurrently.
+    ///
+    /// The tree is measured in passes. Each pass starts the measurements of all asynchronous measurables it reaches
+    /// that have not completed, without waiting for them, and caches only the measurements that did not depend on
+    /// them. The coroutine then waits until the started measurements have completed and measures again,
+    /// until a pass completes without starting any. Every pass after a suspension runs on the thread that completed
+    /// the last measurement. The tree must not be laid out by anything else until the task has completed.
+    ///
+    /// The task keeps the tree alive until it is destroyed, the caller may drop its pointers to the tree
+    /// and the computer before the task completes. With `VPACKCORE_INTRUSIVE_POINTER` the task holds
+    /// a `HandoffPointer`, which leaves the reference count to the calling thread. If the caller has dropped
+    /// its last pointer to the root, the tree is destroyed together with the task.
+    Task<LayoutResult<Identifier, ValueType>> compute_async(Rect<ValueType> frame) const;
+
+    /// Computes the layout of the element in the specified frame, together with the sizes of the frame
+    /// for which the layout keeps its structure.
+    ///
+    /// After the layout, an affine pass repeats the measurement and the placement with values that are functions
+    /// of the size of the frame, and records the sizes for which every comparison of the pass keeps its outcome
+    /// and every item keeps its measurement (see `Measurement`). Resizing the frame within these sizes only moves
+    /// and stretches the frames linearly, which `ResizableLayout::update` calculates without measuring anything.
+    /// If the context installed on the current thread interrupts the layout, the layout holds for no size.
+    ResizableLayout<Identifier, ValueType> compute_resizable(const Rect<ValueType>& frame) const;
+
+    /// Compiles the layout of the element with the specified height into a function of the width of the frame.
+    ///
+    /// Starting at the lowest of the widths, the layout is computed with `compute_resizable` and the next piece
+    /// starts where the validity of the last one ends, until the widths are covered or the maximum number of pieces
+    /// is reached. The returned layout covers fewer widths in the latter case, see `ParametricLayout::widths`.
+    ParametricLayout<Identifier, ValueType> compute_parametric(const Range<ValueType>& widths, ValueType height,
+                                                               std::size_t max_pieces = 64) const;
+
+    /// Creates a layout that runs in slices, see `IncrementalLayout`.
+    IncrementalLayout<Identifier, ValueType> compute_incrementally(const Rect<ValueType>& frame) const;
+
     inline Size<ValueType> compute_dry_layout(const Rect<ValueType>& frame) const {
+        detail::MeasurePassScope pass;
+        item->discard_changed_sizes();
         return item->measure(frame.size());
     }
 
 private:
     LayoutablePointer<Identifier, ValueType> item;
+
+    /// Computes the layout like `compute`, in the measure pass that has been started by the caller.
+    LayoutResult<Identifier, ValueType> compute_in_pass(const Rect<ValueType>& frame) const;
+
+    /// Computes the layout like `compute_resizable`, in the measure pass that has been started by the caller.
+    ResizableLayout<Identifier, ValueType> compute_resizable_in_pass(const Rect<ValueType>& frame) const;
+};
+
+/// A layout that can be interrupted and resumed.
+///
+/// Each call of `resume` works until the layout finishes or the budget is used up, which allows spreading
+/// the layout of a huge tree over several frames. The measured elements keep their cached measurements
+/// between two slices, so a resumed measurement only walks down to the elements that have not been measured.
+/// The tree must not be laid out by anything else until the layout has finished.
+template<typename Identifier, typename ValueType>
+class IncrementalLayout {
+public:
+    IncrementalLayout(LayoutablePointer<Identifier, ValueType> item, const Rect<ValueType>& frame)
+        : item_(std::move(item)), frame_(frame) {
+        item_->resolve_node_kind();
+        item_->discard_changed_sizes();
+        // All slices measure in one pass.
+        context_.begin_measure_pass();
+    }
+
+    /// Continues the layout until it finishes or the budget is used up.
+    ///
+    /// \return Whether the layout has finished.
+    bool resume(const LayoutBudget& budget = LayoutBudget::unlimited());
+
+    inline bool finished() const { return phase_ == Phase::finished; }
+
+    /// The result of the layout, which is incomplete until the layout has finished.
+    inline const LayoutResult<Identifier, ValueType>& result() const { return result_; }
+
+    inline LayoutResult<Identifier, ValueType> take_result() { return std::move(result_); }
+
+    /// The statistics of all slices that have run so far.
+    inline const LayoutStats& stats() const { return context_.stats(); }
+
+private:
+    enum class Phase {
+        measure,
+        place,
+        finished,
+    };
+
+    LayoutablePointer<Identifier, ValueType> item_;
+    Rect<ValueType> frame_;
+    Phase phase_ = Phase::measure;
+    LayoutContext context_;
+    detail::PlacementStack<Identifier, ValueType> placement_;
+    LayoutResult<Identifier, ValueType> result_;
 };
 
 template<typename Identifier, typename ValueType>
 LayoutResult<Identifier, ValueType> LayoutComputer<Identifier, ValueType>::compute(const Rect<ValueType>& frame) const {
+    detail::MeasurePassScope pass;
+    return compute_in_pass(frame);
+}
+
+template<typename Identifier, typename ValueType>
+LayoutResult<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_in_pass(const Rect<ValueType>& frame) const {
+    item->discard_changed_sizes();
     LayoutResult<Identifier, ValueType> result;
-    const EdgeInsets<ValueType> padding = item->padding();
-    const Point<ValueType> offset = item->offset();
+    const Size<ValueType> size = detail::measure_root(*item, frame);
 
-    Size<ValueType> size = item->measure(item->preferred_size(
-        { frame.width - padding.horizontal(), frame.height - padding.vertical() }
-    ));
-    size = item->preferred_size(size);
+    detail::PlacementStack<Identifier, ValueType> placement;
+    placement.push(*item, detail::root_frame(*item, frame, size));
+    placement.run(result);
+    return result;
+}
 
-    item->layout(Rect<ValueType>{
-        (frame.width - size.width) / 2 + padding.left + offset.x,
-        (frame.height - size.height) / 2 + padding.top + offset.y,
-        size.width - padding.horizontal(),
-        size.height - padding.vertical(),
-    }, result);
+template<typename Identifier, typename ValueType>
+LayoutResult<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_parallel(const Rect<ValueType>& frame, Executor* executor,
+                                                        const ParallelPlacementOptions& options) const {
+    detail::MeasurePassScope pass;
+    item->discard_changed_sizes();
+    LayoutResult<Identifier, ValueType> result;
+    const Size<ValueType> size = detail::measure_root(*item, frame);
+    // The tasks of the placement do not share the budget of the context, an interrupted layout stops here.
+    const LayoutContext* context = LayoutContext::current();
+    if (context && context->interrupted()) return result;
+
+    detail::ParallelPlacement<Identifier, ValueType> placement(executor, options);
+    placement.run(*item, detail::root_frame(*item, frame, size), result);
     return result;
 }
 
+template<typename Identifier, typename ValueType>
+Task<LayoutResult<Identifier, ValueType>>
+LayoutComputer<Identifier, ValueType>::compute_async(Rect<ValueType> frame) const {
+    // The computer may be gone when the coroutine resumes.
+    const detail::NodeHandoff<Layoutable<Identifier, ValueType>> root(item);
+    root->discard_changed_sizes();
+    LayoutContext context;
+    context.set_defers_measurements(true);
+    // The measurements of one pass are kept while the coroutine waits for the deferred ones.
+    context.begin_measure_pass();
+    // A scope must not be kept across a suspension, the coroutine may resume on another thread.
+    Size<ValueType> size;
+    while (true) {
+        {
+            LayoutContext::Scope scope(context);
+            size = detail::measure_root(*root, frame);
+        }
+        std::vector<TaskHandle> deferred_measurements = context.take_deferred_measurements();
+        if (deferred_measurements.empty()) break;
+        co_await when_all(std::move(deferred_measurements));
+    }
+
+    LayoutResult<Identifier, ValueType> result;
+    {
+        LayoutContext::Scope scope(context);
+        detail::PlacementStack<Identifier, ValueType> placement;
+        placement.push(*root, detail::root_frame(*root, frame, size));
+        placement.run(result);
+    }
+    co_return result;
+}
+
+template<typename Identifier, typename ValueType>
+ResizableLayout<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_resizable(const Rect<ValueType>& frame) const {
+    detail::MeasurePassScope pass;
+    return compute_resizable_in_pass(frame);
+}
+
+template<typename Identifier, typename ValueType>
+ResizableLayout<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_resizable_in_pass(const Rect<ValueType>& frame) const {
+    using Scalar = Affine<ValueType>;
+    // The affine pass reuses the measurements of the items, it runs in the measure pass of the layout.
+    LayoutResult<Identifier, ValueType> result = compute_in_pass(frame);
+    const LayoutContext* context = LayoutContext::current();
+    if (context && context->interrupted()) {
+        return { std::move(result), frame.size(), { Range<ValueType>::none(), Range<ValueType>::none() }, {}};
+    }
+
+    detail::AffinePass<Identifier, ValueType> pass;
+    detail::AffineConstraints<ValueType> constraints;
+    {
+        typename detail::AffineConstraints<ValueType>::Scope scope(constraints);
+        // The width and the height of the frame are the variables of the affine values.
+        const Rect<Scalar> affine_frame = { frame.x, frame.y, { frame.width, 1, 0 }, { frame.height, 0, 1 }};
+        const EdgeInsets<ValueType> padding = item->padding();
+        const Size<Scalar> size = item->preferred_size(item->measure_affine(item->preferred_size(
+            Size<Scalar>{ affine_frame.width - padding.horizontal(), affine_frame.height - padding.vertical() }
+        ), pass));
+        item->layout_affine(detail::root_frame(*item, affine_frame, size), pass);
+    }
+
+    std::vector<typename ResizableLayout<Identifier, ValueType>::Entry> entries;
+    entries.reserve(pass.frames().size());
+    for (auto& [identifier, affine_frame]: pass.frames()) {
+        const uint16_t z_idx = result.map.at(identifier).z_idx;
+        entries.push_back({ std::move(identifier), affine_frame, z_idx });
+    }
+    return { std::move(result), frame.size(), constraints.validity(frame.size()), std::move(entries) };
+}
+
+template<typename Identifier, typename ValueType>
+ParametricLayout<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_parametric(const Range<ValueType>& widths, ValueType height,
+                                                          std::size_t max_pieces) const {
+    // The pieces share the measurements of the items that hold for several widths.
+    detail::MeasurePassScope pass;
+    ParametricLayout<Identifier, ValueType> layout(height);
+    ValueType width = widths.lower;
+    while (layout.piece_count() < max_pieces && widths.contains(width)) {
+        ResizableLayout<Identifier, ValueType> piece = compute_resizable_in_pass({ 0, 0, width, height });
+        // An interrupted layout holds for no width.
+        if (!piece.validity().width.contains(width)) break;
+        const Range<ValueType> piece_widths = { width, std::min(piece.validity().width.upper, widths.upper) };
+        layout.append(piece_widths, std::move(piece));
+        if (!(piece_widths.upper > width)) break;
+        width = piece_widths.upper;
+    }
+    return layout;
+}
+
+template<typename Identifier, typename ValueType>
+IncrementalLayout<Identifier, ValueType>
+LayoutComputer<Identifier, ValueType>::compute_incrementally(const Rect<ValueType>& frame) const {
+    return { item, frame };
+}
+
+template<typename Identifier, typename ValueType>
+bool IncrementalLayout<Identifier, ValueType>::resume(const LayoutBudget& budget) {
+    context_.set_budget(budget);
+    LayoutContext::Scope scope(context_);
+
+    if (phase_ == Phase::measure) {
+        // An interrupted measurement is started over from the root, the elements that have been measured
+        // completely return their cached sizes.
+        const Size<ValueType> size = detail::measure_root(*item_, frame_);
+        if (context_.interrupted()) return false;
+        placement_.push(*item_, detail::root_frame(*item_, frame_, size));
+        phase_ = Phase::place;
+    }
+    if (phase_ == Phase::place) {
+        if (!placement_.run(result_)) return false;
+        phase_ = Phase::finished;
+    }
+    return true;
+}
+
 }
 
 #endif //VPACKCORE_COMPUTER_HPP
@@ -0,0 +1,298 @@
+//
+// Created by ktiays on 2022/9/10.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_EXECUTOR_HPP
+#define VPACKCORE_EXECUTOR_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+namespace vpk::core {
+
+/// Runs the tasks of the parallel features of the engine.
+///
+/// Every parallel feature takes an optional executor, and runs its tasks inline on the calling thread
+/// if no executor is given.
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    /// Schedules the task to run, possibly on another thread.
+    virtual void execute(Task task) = 0;
+
+    /// The number of tasks the executor can run at the same time.
+    virtual std::size_t concurrency() const { return 1; }
+
+    virtual ~Executor() = default;
+};
+
+/// An executor that runs every task immediately on the calling thread.
+class InlineExecutor : public Executor {
+public:
+    void execute(Task task) override { task(); }
+};
+
+/// Adapts an existing task system to `Executor`.
+///
+/// The function is called with every task and must eventually run it.
+template<typename Function>
+class ExecutorAdapter : public Executor {
+public:
+    explicit ExecutorAdapter(Function function, std::size_t concurrency = std::thread::hardware_concurrency())
+        : function_(std::move(function)), concurrency_(std::max<std::size_t>(1, concurrency)) {}
+
+    void execute(Task task) override { function_(std::move(task)); }
+
+    std::size_t concurrency() const override { return concurrency_; }
+
+private:
+    Function function_;
+    std::size_t concurrency_;
+};
+
+/// A thread pool in which every worker has its own task queue.
+///
+/// Tasks scheduled from a worker go to the queue of that worker and are taken in last-in-first-out order,
+/// which keeps a fork-join computation depth-first. Idle workers steal the oldest tasks of other workers.
+class WorkStealingPool : public Executor {
+public:
+    explicit WorkStealingPool(std::size_t thread_count = std::thread::hardware_concurrency());
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+
+    WorkStealingPool& operator =(const WorkStealingPool&) = delete;
+
+    /// Runs all scheduled tasks and stops the workers.
+    ~WorkStealingPool() override;
+
+    void execute(Task task) override;
+
+    std::size_t concurrency() const override { return workers_.size(); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    struct CurrentWorker {
+        const WorkStealingPool* pool;
+        std::size_t index;
+    };
+
+    static inline thread_local CurrentWorker current_worker_{ nullptr, 0 };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    /// The number of queued tasks that no worker has reserved.
+    std::size_t queued_ = 0;
+    bool stopping_ = false;
+    std::atomic<std::size_t> next_worker_{ 0 };
+
+    bool take(std::size_t index, Task& task);
+
+    void run(std::size_t index);
+};
+
+inline WorkStealingPool::WorkStealingPool(std::size_t thread_count) {
+    thread_count = std::max<std::size_t>(1, thread_count);
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        workers_[i]->thread = std::thread([this, i] { run(i); });
+    }
+}
+
+inline WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    for (const auto& worker: workers_) {
+        worker->thread.join();
+    }
+}
+
+inline void WorkStealingPool::execute(Task task) {
+    const std::size_t index = current_worker_.pool == this
+                              ? current_worker_.index
+                              : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_ += 1;
+    }
+    condition_.notify_one();
+}
+
+inline bool WorkStealingPool::take(std::size_t index, Task& task) {
+    {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void WorkStealingPool::run(std::size_t index) {
+    current_worker_ = { this, index };
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (queued_ == 0) return;
+            // Reserve one of the queued tasks. A task is queued before it is counted and only reserving workers
+            // take tasks, so there is always a task left for each reservation.
+            queued_ -= 1;
+        }
+
+        Task task;
+        while (!take(index, task)) {
+            std::this_thread::yield();
+        }
+        task();
+    }
+}
+
+/// Runs a set of tasks on an executor and waits for all of them, i.e. the fork and join of a computation.
+///
+/// Tasks that no thread of the executor has started when `wait` is called are run by the waiting thread,
+/// so waiting inside a task of the same executor never deadlocks. Without an executor, every task runs
+/// immediately when it is added.
+class TaskGroup {
+public:
+    explicit TaskGroup(Executor* executor)
+        : executor_(executor) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+
+    TaskGroup& operator =(const TaskGroup&) = delete;
+
+    /// Drops the tasks that have not been started and waits for the others.
+    ~TaskGroup();
+
+    void run(Executor::Task task);
+
+    /// Waits until all tasks have finished, and rethrows the first exception thrown by a task.
+    void wait();
+
+private:
+    struct Entry {
+        Executor::Task task;
+        std::atomic<bool> claimed{ false };
+    };
+
+    Executor* executor_;
+    std::vector<std::shared_ptr<Entry>> entries_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    /// The number of tasks that have not finished.
+    std::size_t unfinished_ = 0;
+    std::exception_ptr exception_;
+
+    void invoke(Entry& entry);
+
+    void finish();
+
+    void wait_for_unfinished_tasks();
+};
+
+inline TaskGroup::~TaskGroup() {
+    for (const auto& entry: entries_) {
+        if (!entry->claimed.exchange(true)) finish();
+    }
+    wait_for_unfinished_tasks();
+}
+
+inline void TaskGroup::run(Executor::Task task) {
+    if (!executor_) {
+        task();
+        return;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->task = std::move(task);
+    entries_.push_back(entry);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unfinished_ += 1;
+    }
+    executor_->execute([this, entry = std::move(entry)] {
+        // The waiting thread may have taken the task already, the group must not be touched in that case.
+        if (entry->claimed.exchange(true)) return;
+        invoke(*entry);
+    });
+}
+
+inline void TaskGroup::invoke(Entry& entry) {
+    try {
+        entry.task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!exception_) exception_ = std::current_exception();
+    }
+    finish();
+}
+
+inline void TaskGroup::finish() {
+    // The waiting thread may destroy the group as soon as the count drops to zero,
+    // so the condition variable has to be notified before the mutex is released.
+    std::lock_guard<std::mutex> lock(mutex_);
+    unfinished_ -= 1;
+    condition_.notify_all();
+}
+
+inline void TaskGroup::wait() {
+    // Run the tasks that have not been started by the executor, the most recent one first.
+    for (auto iter = entries_.rbegin(); iter != entries_.rend(); ++iter) {
+        Entry& entry = **iter;
+        if (!entry.claimed.exchange(true)) invoke(entry);
+    }
+    wait_for_unfinished_tasks();
+    entries_.clear();
+
+    std::exception_ptr exception;
+    std::swap(exception, exception_);
+    if (exception) std::rethrow_exception(exception);
+}
+
+inline void TaskGroup::wait_for_unfinished_tasks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return unfinished_ == 0; });
+}
+
+}
+
+#endif //VPACKCORE_EXECUTOR_HPP
@@ -0,0 +1,214 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_FIXED_POINT_HPP
+#define VPACKCORE_FIXED_POINT_HPP
+
+#include <limits>
+#include <compare>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace vpk::core {
+
+/// A signed fixed-point number with `FractionBits` fractional bits stored in an `int32_t`, a value type
+/// for layouts that are bit-exact on every machine.
+///
+/// The default 24.8 format covers about ±8388607 with a resolution of 1/256. The largest raw value is
+/// the infinity and its negation the negative infinity: the arithmetic saturates to them instead of
+/// overflowing, and an infinity absorbs every finite operand. The smallest raw value is reserved as the empty
+/// value of a compact optional (`std::numeric_limits::lowest`) and never results from an operation.
+///
+/// Products and quotients round toward negative infinity, so halving a difference, e.g. to center an element,
+/// gives the same fraction wherever the elements are. Conversions from floating-point values round to nearest.
+template<int FractionBits = 8>
+class FixedPoint {
+    static_assert(FractionBits > 0 && FractionBits < 31);
+
+public:
+    using RawType = int32_t;
+
+    static constexpr int fraction_bits = FractionBits;
+
+    constexpr FixedPoint() noexcept
+        : raw_(0) {}
+
+    template<typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    constexpr FixedPoint(T value) noexcept
+        : raw_(saturate_integer(value)) {}
+
+    template<typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    constexpr FixedPoint(T value) noexcept
+        : raw_(saturate_floating_point(static_cast<double>(value))) {}
+
+    static constexpr FixedPoint from_raw(RawType raw) noexcept {
+        FixedPoint value;
+        value.raw_ = raw;
+        return value;
+    }
+
+    constexpr RawType raw() const noexcept { return raw_; }
+
+    constexpr bool is_infinite() const noexcept { return raw_ == infinity_raw || raw_ == -infinity_raw; }
+
+    constexpr double to_double() const noexcept {
+        if (raw_ == infinity_raw) return std::numeric_limits<double>::infinity();
+        if (raw_ == -infinity_raw) return -std::numeric_limits<double>::infinity();
+        return static_cast<double>(raw_) / one_raw;
+    }
+
+    constexpr explicit operator double() const noexcept { return to_double(); }
+
+    constexpr explicit operator float() const noexcept { return static_cast<float>(to_double()); }
+
+    constexpr FixedPoint operator -() const noexcept { return from_raw(-raw_); }
+
+    constexpr FixedPoint& operator +=(FixedPoint other) noexcept { return *this = *this + other; }
+
+    constexpr FixedPoint& operator -=(FixedPoint other) noexcept { return *this = *this - other; }
+
+    constexpr FixedPoint& operator *=(FixedPoint other) noexcept { return *this = *this * other; }
+
+    constexpr FixedPoint& operator /=(FixedPoint other) noexcept { return *this = *this / other; }
+
+    friend constexpr FixedPoint operator +(FixedPoint a, FixedPoint b) noexcept {
+        if (a.is_infinite() || b.is_infinite()) {
+            // Opposite infinities cancel out, there is no NaN.
+            if (a.is_infinite() && b.is_infinite() && a.raw_ != b.raw_) return {};
+            return a.is_infinite() ? a : b;
+        }
+        return saturate(static_cast<int64_t>(a.raw_) + b.raw_);
+    }
+
+    friend constexpr FixedPoint operator -(FixedPoint a, FixedPoint b) noexcept { return a + -b; }
+
+    friend constexpr FixedPoint operator *(FixedPoint a, FixedPoint b) noexcept {
+        if (a.is_infinite() || b.is_infinite()) {
+            if (a.raw_ == 0 || b.raw_ == 0) return {};
+            return signed_infinity((a.raw_ < 0) != (b.raw_ < 0));
+        }
+        return saturate(floor_shift(static_cast<int64_t>(a.raw_) * b.raw_));
+    }
+
+    friend constexpr FixedPoint operator /(FixedPoint a, FixedPoint b) noexcept {
+        if (b.is_infinite()) {
+            if (!a.is_infinite()) return {};
+            return from_raw((a.raw_ < 0) != (b.raw_ < 0) ? -one_raw : one_raw);
+        }
+        if (a.is_infinite() || b.raw_ == 0) {
+            if (a.raw_ == 0) return {};
+            return signed_infinity((a.raw_ < 0) != (b.raw_ < 0));
+        }
+        return saturate(floor_divide(static_cast<int64_t>(a.raw_) * one_raw, b.raw_));
+    }
+
+    friend constexpr bool operator ==(FixedPoint a, FixedPoint b) noexcept = default;
+
+    friend constexpr std::strong_ordering operator <=>(FixedPoint a, FixedPoint b) noexcept {
+        return a.raw_ <=> b.raw_;
+    }
+
+    /* Found by argument-dependent lookup where the layout calls the functions of `<cmath>` unqualified. */
+
+    friend constexpr FixedPoint abs(FixedPoint value) noexcept { return value.raw_ < 0 ? -value : value; }
+
+    friend constexpr bool isinf(FixedPoint value) noexcept { return value.is_infinite(); }
+
+    friend constexpr FixedPoint nextafter(FixedPoint from, FixedPoint to) noexcept {
+        if (from == to) return to;
+        return from_raw(from < to ? from.raw_ + 1 : from.raw_ - 1);
+    }
+
+private:
+    static constexpr RawType one_raw = RawType(1) << FractionBits;
+    static constexpr RawType infinity_raw = std::numeric_limits<RawType>::max();
+
+    RawType raw_;
+
+    static constexpr FixedPoint signed_infinity(bool negative) noexcept {
+        return from_raw(negative ? -infinity_raw : infinity_raw);
+    }
+
+    /// The value of a raw result, which turns into an infinity if it is out of the finite range.
+    static constexpr FixedPoint saturate(int64_t raw) noexcept {
+        if (raw >= infinity_raw) return signed_infinity(false);
+        if (raw <= -infinity_raw) return signed_infinity(true);
+        return from_raw(static_cast<RawType>(raw));
+    }
+
+    static constexpr int64_t floor_shift(int64_t value) noexcept {
+        // The shift of a negative value is arithmetic in C++20, i.e. rounds toward negative infinity.
+        return value >> FractionBits;
+    }
+
+    static constexpr int64_t floor_divide(int64_t dividend, int64_t divisor) noexcept {
+        const int64_t quotient = dividend / divisor;
+        return (dividend % divisor != 0 && (dividend < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+    }
+
+    template<typename T>
+    static constexpr RawType saturate_integer(T value) noexcept {
+        constexpr int64_t limit = infinity_raw / one_raw;
+        if constexpr (std::is_signed_v<T>) {
+            if (value < -limit) return -infinity_raw;
+            if (value > limit) return infinity_raw;
+        } else {
+            if (value > static_cast<uint64_t>(limit)) return infinity_raw;
+        }
+        return static_cast<RawType>(static_cast<int64_t>(value) * one_raw);
+    }
+
+    static constexpr RawType saturate_floating_point(double value) noexcept {
+        const double raw = value * one_raw;
+        if (raw >= infinity_raw) return infinity_raw;
+        if (raw <= -infinity_raw) return -infinity_raw;
+        // Round half away from zero, `std::round` is not constexpr.
+        return static_cast<RawType>(raw < 0 ? raw - 0.5 : raw + 0.5);
+    }
+};
+
+}
+
+template<int FractionBits>
+class std::numeric_limits<vpk::core::FixedPoint<FractionBits>> {
+    using Type = vpk::core::FixedPoint<FractionBits>;
+    using RawLimits = std::numeric_limits<typename Type::RawType>;
+
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr bool has_signaling_NaN = false;
+    static constexpr int digits = RawLimits::digits;
+    static constexpr int radix = 2;
+
+    static constexpr Type infinity() noexcept { return Type::from_raw(RawLimits::max()); }
+
+    /// The largest finite value.
+    static constexpr Type max() noexcept { return Type::from_raw(RawLimits::max() - 1); }
+
+    /// The smallest positive value.
+    static constexpr Type min() noexcept { return Type::from_raw(1); }
+
+    /// The reserved value below the negative infinity.
+    static constexpr Type lowest() noexcept { return Type::from_raw(RawLimits::min()); }
+
+    /// The resolution of the type.
+    static constexpr Type epsilon() noexcept { return Type::from_raw(1); }
+};
+
+template<int FractionBits>
+struct std::hash<vpk::core::FixedPoint<FractionBits>> {
+    inline std::size_t operator ()(const vpk::core::FixedPoint<FractionBits>& value) const noexcept {
+        return std::hash<typename vpk::core::FixedPoint<FractionBits>::RawType>{}(value.raw());
+    }
+};
+
+#endif //VPACKCORE_FIXED_POINT_HPP
@@ -0,0 +1,143 @@
+//
+// Created by ktiays on 2022/9/2.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_INTERNED_IDENTIFIER_HPP
+#define VPACKCORE_INTERNED_IDENTIFIER_HPP
+
+#include <deque>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+#include "optional.hpp"
+
+namespace vpk::core {
+
+/// A compact handle of an identifier that has been interned by an `IdentifierInterner`.
+///
+/// The hash value of the original identifier is computed once when the identifier is interned,
+/// so hashing and comparing handles never touches the original identifier.
+/// Handles are only comparable with handles created by the same interner.
+class InternedIdentifier {
+public:
+    using IndexType = uint32_t;
+
+    constexpr InternedIdentifier()
+        : index_(invalid_index), hash_(0) {}
+
+    /// The position of the identifier in the interner that created the handle.
+    inline IndexType index() const { return index_; }
+
+    /// The cached hash value of the original identifier.
+    inline std::size_t hash() const { return hash_; }
+
+    inline bool valid() const { return index_ != invalid_index; }
+
+    inline bool operator ==(const InternedIdentifier& other) const {
+        return index_ == other.index_;
+    }
+
+    inline bool operator !=(const InternedIdentifier& other) const {
+        return !(*this == other);
+    }
+
+private:
+    template<typename, typename> friend class IdentifierInterner;
+
+    static constexpr IndexType invalid_index = std::numeric_limits<IndexType>::max();
+
+    constexpr InternedIdentifier(IndexType index, std::size_t hash)
+        : index_(index), hash_(hash) {}
+
+    IndexType index_;
+    std::size_t hash_;
+};
+
+/// Maps identifiers to `InternedIdentifier` handles.
+///
+/// Interning is meant to happen while the layout tree is built, after that the handles can be used as
+/// the identifier type of the engine, and `resolve` turns the keys of a layout result back into identifiers.
+/// The interner is not thread-safe.
+template<typename Identifier, typename Hash = std::hash<Identifier>>
+class IdentifierInterner {
+public:
+    /// Returns the handle of the identifier, interning it if it has not been seen before.
+    InternedIdentifier intern(const Identifier& identifier) {
+        const std::size_t hash = Hash{}(identifier);
+        if (const auto handle = find(identifier, hash)) return *handle;
+        identifiers_.push_back(identifier);
+        return insert(hash);
+    }
+
+    InternedIdentifier intern(Identifier&& identifier) {
+        const std::size_t hash = Hash{}(identifier);
+        if (const auto handle = find(identifier, hash)) return *handle;
+        identifiers_.push_back(std::move(identifier));
+        return insert(hash);
+    }
+
+    /// Returns the handle of the identifier if it has been interned.
+    optional<InternedIdentifier> find(const Identifier& identifier) const {
+        return find(identifier, Hash{}(identifier));
+    }
+
+    /// Returns the identifier that the handle refers to.
+    const Identifier& resolve(const InternedIdentifier& handle) const {
+        assert(handle.index() < identifiers_.size());
+        return identifiers_[handle.index()];
+    }
+
+    inline std::size_t size() const { return identifiers_.size(); }
+
+    void clear() {
+        indices_.clear();
+        identifiers_.clear();
+    }
+
+private:
+    struct Entry {
+        const Identifier* identifier;
+        std::size_t hash;
+    };
+
+    struct EntryHash {
+        inline std::size_t operator ()(const Entry& entry) const { return entry.hash; }
+    };
+
+    struct EntryEqual {
+        inline bool operator ()(const Entry& a, const Entry& b) const { return *a.identifier == *b.identifier; }
+    };
+
+    // A deque never relocates its elements, so the map can refer to the stored identifiers
+    // instead of keeping a second copy of each of them.
+    std::deque<Identifier> identifiers_;
+    std::unordered_map<Entry, InternedIdentifier::IndexType, EntryHash, EntryEqual> indices_;
+
+    optional<InternedIdentifier> find(const Identifier& identifier, std::size_t hash) const {
+        const auto iter = indices_.find(Entry{ &identifier, hash });
+        if (iter == indices_.end()) return nullopt;
+        return InternedIdentifier(iter->second, hash);
+    }
+
+    InternedIdentifier insert(std::size_t hash) {
+        assert(identifiers_.size() < InternedIdentifier::invalid_index);
+        const auto index = static_cast<InternedIdentifier::IndexType>(identifiers_.size() - 1);
+        indices_.emplace(Entry{ &identifiers_.back(), hash }, index);
+        return { index, hash };
+    }
+};
+
+}
+
+template<>
+struct std::hash<vpk::core::InternedIdentifier> {
+    inline std::size_t operator ()(const vpk::core::InternedIdentifier& identifier) const noexcept {
+        return identifier.hash();
+    }
+};
+
+#endif //VPACKCORE_INTERNED_IDENTIFIER_HPP
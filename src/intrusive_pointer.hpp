@@ -0,0 +1,191 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_INTRUSIVE_POINTER_HPP
+#define VPACKCORE_INTRUSIVE_POINTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+
+namespace vpk::core {
+
+/// The reference count of an object owned by `IntrusivePointer`s, stored in the object itself.
+///
+/// The count is not atomic, the pointers to an object must only be copied and destroyed by one thread at a time.
+/// An object that has to be kept alive by another thread is handed to it with a `HandoffPointer`.
+class ReferenceCounted {
+public:
+    /// The number of pointers that own the object.
+    inline uint32_t reference_count() const { return reference_count_; }
+
+protected:
+    ReferenceCounted() = default;
+
+    /// A copy of an object is owned by no pointer.
+    ReferenceCounted(const ReferenceCounted&) {}
+
+    ReferenceCounted& operator =(const ReferenceCounted&) { return *this; }
+
+    ~ReferenceCounted() = default;
+
+private:
+    template<typename T>
+    friend class IntrusivePointer;
+
+    template<typename T>
+    friend class HandoffPointer;
+
+    /// Set in `handoff_state_` when the last intrusive pointer has been destroyed while handoff pointers remain.
+    static constexpr uint32_t orphaned = uint32_t(1) << 31;
+
+    mutable uint32_t reference_count_ = 0;
+    /// The number of handoff pointers to the object, together with the `orphaned` flag.
+    mutable std::atomic<uint32_t> handoff_state_{ 0 };
+
+    /// Called when the last intrusive pointer to the object has been destroyed.
+    ///
+    /// \return Whether the object can be deleted, otherwise the last handoff pointer deletes it.
+    inline bool release_last_reference() const noexcept {
+        // Handoff pointers are only created by the owning thread, none can appear once the state has been read.
+        if (handoff_state_.load(std::memory_order_acquire) == 0) return true;
+        return handoff_state_.fetch_or(orphaned, std::memory_order_acq_rel) == 0;
+    }
+};
+
+/// A pointer that shares the ownership of an object with a reference count stored in the object,
+/// see `ReferenceCounted`.
+///
+/// Unlike `std::shared_ptr` it needs no separate control block and no atomic operations. The object is deleted
+/// through a pointer of type `T`, so `T` needs a virtual destructor when it points to derived objects.
+template<typename T>
+class IntrusivePointer {
+public:
+    using element_type = T;
+
+    constexpr IntrusivePointer() noexcept = default;
+
+    constexpr IntrusivePointer(std::nullptr_t) noexcept {}
+
+    /// Takes ownership of the object.
+    explicit IntrusivePointer(T* pointer) noexcept
+        : pointer_(pointer) {
+        retain();
+    }
+
+    IntrusivePointer(const IntrusivePointer& other) noexcept
+        : IntrusivePointer(other.pointer_) {}
+
+    IntrusivePointer(IntrusivePointer&& other) noexcept
+        : pointer_(std::exchange(other.pointer_, nullptr)) {}
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePointer(const IntrusivePointer<U>& other) noexcept
+        : IntrusivePointer(other.get()) {}
+
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePointer(IntrusivePointer<U>&& other) noexcept
+        : pointer_(other.release()) {}
+
+    IntrusivePointer& operator =(IntrusivePointer other) noexcept {
+        std::swap(pointer_, other.pointer_);
+        return *this;
+    }
+
+    ~IntrusivePointer() { reset(); }
+
+    inline T* get() const noexcept { return pointer_; }
+
+    inline T& operator *() const noexcept { return *pointer_; }
+
+    inline T* operator ->() const noexcept { return pointer_; }
+
+    inline explicit operator bool() const noexcept { return pointer_ != nullptr; }
+
+    /// The number of pointers that own the object, 0 if the pointer is null.
+    inline long use_count() const noexcept { return pointer_ ? pointer_->reference_count() : 0; }
+
+    void reset() noexcept {
+        if (!pointer_) return;
+        const ReferenceCounted* counted = pointer_;
+        if (--counted->reference_count_ == 0 && counted->release_last_reference()) delete pointer_;
+        pointer_ = nullptr;
+    }
+
+    /// Gives up the ownership of the object without changing its reference count.
+    [[nodiscard]] inline T* release() noexcept { return std::exchange(pointer_, nullptr); }
+
+    friend bool operator ==(const IntrusivePointer& a, const IntrusivePointer& b) noexcept {
+        return a.pointer_ == b.pointer_;
+    }
+
+    friend bool operator ==(const IntrusivePointer& a, std::nullptr_t) noexcept { return !a; }
+
+private:
+    T* pointer_ = nullptr;
+
+    inline void retain() const noexcept {
+        const ReferenceCounted* counted = pointer_;
+        if (counted) counted->reference_count_ += 1;
+    }
+};
+
+/// A pointer that keeps an object owned by `IntrusivePointer`s alive on another thread.
+///
+/// It is created from an intrusive pointer on the thread that owns the object, and may then be moved to
+/// and destroyed on any thread. It does not touch the reference count, it is counted separately with an atomic
+/// operation: if the last intrusive pointer is destroyed first, the last handoff pointer deletes the object.
+template<typename T>
+class HandoffPointer {
+public:
+    using element_type = T;
+
+    explicit HandoffPointer(const IntrusivePointer<T>& pointer) noexcept
+        : pointer_(pointer.get()) {
+        const ReferenceCounted* counted = pointer_;
+        if (counted) counted->handoff_state_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    HandoffPointer(HandoffPointer&& other) noexcept
+        : pointer_(std::exchange(other.pointer_, nullptr)) {}
+
+    HandoffPointer& operator =(HandoffPointer other) noexcept {
+        std::swap(pointer_, other.pointer_);
+        return *this;
+    }
+
+    ~HandoffPointer() { reset(); }
+
+    inline T* get() const noexcept { return pointer_; }
+
+    inline T& operator *() const noexcept { return *pointer_; }
+
+    inline T* operator ->() const noexcept { return pointer_; }
+
+    inline explicit operator bool() const noexcept { return pointer_ != nullptr; }
+
+    void reset() noexcept {
+        if (!pointer_) return;
+        const ReferenceCounted* counted = pointer_;
+        const uint32_t state = counted->handoff_state_.fetch_sub(1, std::memory_order_acq_rel);
+        if (state == (ReferenceCounted::orphaned | 1)) delete pointer_;
+        pointer_ = nullptr;
+    }
+
+private:
+    T* pointer_ = nullptr;
+};
+
+/// Creates an object owned by an `IntrusivePointer`.
+template<typename T, typename... Args>
+IntrusivePointer<T> make_intrusive(Args&& ... args) {
+    return IntrusivePointer<T>(new T(std::forward<Args>(args)...));
+}
+
+}
+
+#endif //VPACKCORE_INTRUSIVE_POINTER_HPP
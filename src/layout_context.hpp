@@ -0,0 +1,343 @@
+//
+// Created by ktiays on 2022/9/5.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_LAYOUT_CONTEXT_HPP
+#define VPACKCORE_LAYOUT_CONTEXT_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <cassert>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "task.hpp"
+#include "optional.hpp"
+
+namespace vpk::core {
+
+/// The number of independent measurement states an element can keep, see `detail::MeasureBuffers`.
+///
+/// A layout measures into and places from the buffer selected by its context,
+/// so one buffer can be placed while the next layout is measured into the other one.
+inline constexpr std::size_t measure_buffer_count = 2;
+
+/// How the parallel placement of `LayoutComputer::compute_parallel` split the tree.
+struct ParallelPlacementStats {
+    /// The number of tasks that placed a single large subtree.
+    std::size_t subtree_tasks = 0;
+    /// The number of tasks that placed a run of small sibling subtrees together.
+    std::size_t batch_tasks = 0;
+    /// The number of subtrees that were placed without being split, by the thread that reached them.
+    std::size_t serial_subtrees = 0;
+    /// The cost of placing the tree that the decisions were based on.
+    std::chrono::nanoseconds estimated_cost{};
+    /// The time the threads spent placing the tree, the sum over all tasks.
+    std::chrono::nanoseconds measured_cost{};
+    /// The estimated cost a task needed to reach to be forked.
+    std::chrono::nanoseconds min_task_cost{};
+};
+
+/// Counters collected while a layout runs in a `LayoutContext`.
+struct LayoutStats {
+    /// The number of elements whose size was calculated.
+    std::size_t measured_nodes = 0;
+    /// The number of measurements answered by the cached measurement of an element.
+    std::size_t cached_nodes = 0;
+    /// The number of measurements that were calculated in batches, see `BatchMeasurable`.
+    std::size_t batched_nodes = 0;
+    /// The number of elements that were placed.
+    std::size_t placed_nodes = 0;
+    ParallelPlacementStats parallel;
+};
+
+/// Limits the amount of work a layout may do before it yields.
+struct LayoutBudget {
+    using Clock = std::chrono::steady_clock;
+
+    /// The maximum number of elements that may be measured or placed.
+    std::size_t nodes = std::numeric_limits<std::size_t>::max();
+    /// The point in time after which the layout yields.
+    optional<Clock::time_point> deadline;
+
+    static LayoutBudget unlimited() { return {}; }
+
+    static LayoutBudget node_count(std::size_t count) { return { count, nullopt }; }
+
+    static LayoutBudget until(Clock::time_point time) {
+        return { std::numeric_limits<std::size_t>::max(), time };
+    }
+
+    template<typename Rep, typename Period>
+    static LayoutBudget within(std::chrono::duration<Rep, Period> duration) {
+        return until(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+};
+
+/// A flag shared between a layout and the code that requested it, which can stop the layout early.
+///
+/// Copies of a token share the same flag. A default constructed token can never be cancelled.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    /// Creates a token that can be cancelled.
+    static CancellationToken make() {
+        CancellationToken token;
+        token.flag_ = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    void cancel() const {
+        if (flag_) flag_->store(true, std::memory_order_relaxed);
+    }
+
+    inline bool cancelled() const {
+        return flag_ && flag_->load(std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+/// The state shared by all elements taking part in one layout pass on the current thread.
+///
+/// A context is installed with `LayoutContext::Scope`. Elements consult the installed context before each
+/// measurement and placement, so a context can interrupt a layout between two elements and collects
+/// statistics about it. Without an installed context, layouts always run to completion.
+/// A context must only be used by one layout at a time.
+class LayoutContext {
+public:
+    LayoutContext() = default;
+
+    LayoutContext(const LayoutContext&) = delete;
+
+    LayoutContext& operator =(const LayoutContext&) = delete;
+
+    /// Installs a context for the current thread during the lifetime of the scope.
+    class Scope {
+    public:
+        explicit Scope(LayoutContext& context)
+            : previous_(current_) {
+            current_ = &context;
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator =(const Scope&) = delete;
+
+        ~Scope() { current_ = previous_; }
+
+    private:
+        LayoutContext* previous_;
+    };
+
+    /// The context installed on the current thread, or null if there is none.
+    static inline LayoutContext* current() { return current_; }
+
+    /// Replaces the budget of the context and clears a previous interruption.
+    void set_budget(const LayoutBudget& budget) {
+        remaining_nodes_ = budget.nodes;
+        deadline_ = budget.deadline;
+        ticks_ = 0;
+        interrupted_ = false;
+        made_progress_ = false;
+    }
+
+    /// Makes the context interrupt the layout as soon as the token is cancelled.
+    ///
+    /// The token is checked between elements, so a cancelled layout stops after the element being measured
+    /// or placed. Interrupted measurements are never cached, which keeps the tree consistent for the next layout.
+    void set_cancellation_token(CancellationToken token) {
+        cancellation_token_ = std::move(token);
+    }
+
+    /// Selects the measurement state used by the layout running in the context.
+    void set_measure_buffer(std::size_t buffer) {
+        assert(buffer < measure_buffer_count);
+        measure_buffer_ = buffer;
+    }
+
+    inline std::size_t measure_buffer() const { return measure_buffer_; }
+
+    /// Starts a new measure pass, called by every layout before it measures the tree.
+    ///
+    /// The measurements that elements cache only answer measurements of the pass they have been calculated in,
+    /// so a layout never returns the measurement of content that has changed since an earlier layout.
+    /// Several slices of one layout, e.g. of `IncrementalLayout`, measure in the same pass.
+    void begin_measure_pass() {
+        if (retains_measurements_ && measure_pass_ != 0) return;
+        measure_pass_ = next_measure_pass_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Makes all layouts running in the context measure in one pass, so they reuse the cached measurements
+    /// of the elements, e.g. while a window is resized.
+    ///
+    /// The caller must then call `Layoutable::invalidate_measure_cache` whenever something a measurement
+    /// depends on has changed.
+    void set_retains_measurements(bool retains) { retains_measurements_ = retains; }
+
+    /// The current measure pass, 0 if no pass has been started.
+    inline uint64_t measure_pass() const { return measure_pass_; }
+
+    /// Allows asynchronous measurables to defer their measurements, see `LayoutComputer::compute_async`.
+    ///
+    /// Instead of waiting for an asynchronous measurement, the item starts it, registers it with
+    /// `defer_measurement` and reports an empty size, so the measurements of the other items can be started
+    /// during the same pass. Measurements that depend on a deferred one are not cached.
+    void set_defers_measurements(bool defers) { defers_measurements_ = defers; }
+
+    inline bool defers_measurements() const { return defers_measurements_; }
+
+    void defer_measurement(TaskHandle task) { deferred_measurements_.push_back(std::move(task)); }
+
+    /// The number of measurements that have been deferred since they were last taken.
+    inline std::size_t deferred_measurement_count() const { return deferred_measurements_.size(); }
+
+    inline std::vector<TaskHandle> take_deferred_measurements() { return std::move(deferred_measurements_); }
+
+    /// Whether the layout running in the context has been interrupted.
+    ///
+    /// Once interrupted, elements stop doing work and no measurement is cached
+    /// until the budget is replaced.
+    inline bool interrupted() const { return interrupted_; }
+
+    inline const LayoutStats& stats() const { return stats_; }
+
+    inline LayoutStats& stats() { return stats_; }
+
+    /// Accounts for one element that is about to be measured or placed.
+    ///
+    /// The budget is only enforced after an element has completed its work since the budget was set, so every
+    /// slice of an interrupted layout makes progress even if it exceeds its budget by the depth of the tree.
+    ///
+    /// \return Whether the element may do its work.
+    bool consume() {
+        if (interrupted_) return false;
+        // A cancelled layout is never displayed, there is no need to make progress.
+        if (cancellation_token_.cancelled()) return interrupt();
+        if (remaining_nodes_ > 0) --remaining_nodes_;
+        else if (made_progress_) return interrupt();
+        // Reading the clock costs more than measuring a simple element, so the deadline is only checked
+        // once every few elements.
+        if (deadline_.has_value() && (ticks_++ % deadline_check_interval) == 0
+            && made_progress_ && LayoutBudget::Clock::now() >= *deadline_) {
+            return interrupt();
+        }
+        return true;
+    }
+
+    /// Records that an element has completed its work.
+    inline void record_progress() { made_progress_ = true; }
+
+private:
+    static constexpr std::size_t deadline_check_interval = 32;
+
+    bool interrupt() {
+        interrupted_ = true;
+        return false;
+    }
+
+    static inline thread_local LayoutContext* current_ = nullptr;
+    static inline std::atomic<uint64_t> next_measure_pass_{ 1 };
+
+    std::size_t remaining_nodes_ = std::numeric_limits<std::size_t>::max();
+    optional<LayoutBudget::Clock::time_point> deadline_;
+    std::size_t ticks_ = 0;
+    CancellationToken cancellation_token_;
+    std::size_t measure_buffer_ = 0;
+    uint64_t measure_pass_ = 0;
+    bool interrupted_ = false;
+    bool made_progress_ = false;
+    bool defers_measurements_ = false;
+    bool retains_measurements_ = false;
+    std::vector<TaskHandle> deferred_measurements_;
+    LayoutStats stats_;
+};
+
+namespace detail {
+
+/// The measurement buffer selected by the context installed on the current thread.
+inline std::size_t current_measure_buffer() {
+    const LayoutContext* context = LayoutContext::current();
+    return context ? context->measure_buffer() : 0;
+}
+
+/// The measure pass of the context installed on the current thread, 0 if there is none.
+///
+/// Nothing is cached outside of a measure pass.
+inline uint64_t current_measure_pass() {
+    const LayoutContext* context = LayoutContext::current();
+    return context ? context->measure_pass() : 0;
+}
+
+/// A state that an element keeps once per measurement buffer, see `measure_buffer_count`.
+///
+/// The state of the first buffer is kept inline. The states of the other buffers, which only the pipelined layout
+/// measures into, are allocated when one of them is first written, so an element that is never laid out
+/// by a pipeline pays for one pointer instead of another state.
+template<typename T>
+class MeasureBuffers {
+public:
+    inline T& operator [](std::size_t buffer) {
+        if (buffer == 0) return first_;
+        if (!others_) others_ = std::make_unique<std::array<T, measure_buffer_count - 1>>();
+        return (*others_)[buffer - 1];
+    }
+
+    /// The state of a buffer that has not been written to yet is a default-constructed one.
+    inline const T& operator [](std::size_t buffer) const {
+        if (buffer == 0) return first_;
+        if (!others_) return empty_;
+        return (*others_)[buffer - 1];
+    }
+
+    /// Calls the function on the state of every buffer that has been allocated.
+    template<typename Function>
+    void for_each(Function&& function) {
+        function(first_);
+        if (!others_) return;
+        for (T& state: *others_) {
+            function(state);
+        }
+    }
+
+private:
+    T first_{};
+    std::unique_ptr<std::array<T, measure_buffer_count - 1>> others_;
+
+    inline static const T empty_{};
+};
+
+/// Starts a measure pass for the lifetime of the scope, in the context installed on the current thread
+/// or in a context of its own if there is none.
+class MeasurePassScope {
+public:
+    MeasurePassScope() {
+        LayoutContext* context = LayoutContext::current();
+        if (!context) {
+            context = &context_.emplace();
+            scope_.emplace(*context);
+        }
+        context->begin_measure_pass();
+    }
+
+    MeasurePassScope(const MeasurePassScope&) = delete;
+
+    MeasurePassScope& operator =(const MeasurePassScope&) = delete;
+
+private:
+    optional<LayoutContext> context_;
+    optional<LayoutContext::Scope> scope_;
+};
+
+}
+
+}
+
+#endif //VPACKCORE_LAYOUT_CONTEXT_HPP
@@ -0,0 +1,154 @@
+//
+// Created by ktiays on 2022/9/6.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_LAYOUT_JOB_HPP
+#define VPACKCORE_LAYOUT_JOB_HPP
+
+#include <mutex>
+#include <future>
+#include <exception>
+#include <condition_variable>
+
+#include "computer.hpp"
+#include "executor.hpp"
+#include "layout_context.hpp"
+#include "optional.hpp"
+
+namespace vpk::core {
+
+/// Lays out a tree on an executor and only keeps the newest request.
+///
+/// During a window resize, a new size often arrives before the layout of the previous one has finished.
+/// Submitting the new size drops the request that has not started yet and cancels the running layout,
+/// so no work is spent on layouts that will never be displayed.
+/// Without an executor, every request is laid out on the thread that submits it.
+/// The tree must not be laid out by anything else while it is owned by the manager.
+template<typename Identifier, typename ValueType>
+class LayoutJobManager {
+public:
+    /// The result of a request, which holds no value if the request was dropped or cancelled.
+    using JobResult = optional<LayoutResult<Identifier, ValueType>>;
+
+    explicit LayoutJobManager(LayoutablePointer<Identifier, ValueType> item, Executor* executor = nullptr)
+        : computer_(std::move(item)), executor_(executor) {}
+
+    LayoutJobManager(const LayoutJobManager&) = delete;
+
+    LayoutJobManager& operator =(const LayoutJobManager&) = delete;
+
+    ~LayoutJobManager();
+
+    /// Requests a layout of the tree in the specified frame.
+    ///
+    /// If the layout throws, the future rethrows the exception and the following requests are laid out as usual.
+    std::future<JobResult> submit(const Rect<ValueType>& frame);
+
+private:
+    struct Job {
+        Rect<ValueType> frame;
+        CancellationToken token;
+        std::promise<JobResult> promise;
+    };
+
+    LayoutComputer<Identifier, ValueType> computer_;
+    Executor* executor_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    /// The newest request that has not started yet.
+    optional<Job> pending_;
+    /// The token of the running layout.
+    CancellationToken running_token_;
+    /// Whether a task that lays out the pending requests has been scheduled.
+    bool running_ = false;
+    bool stopping_ = false;
+
+    /// Lays out the pending requests until there is none left.
+    void run();
+
+    JobResult compute(const Job& job) const;
+};
+
+template<typename Identifier, typename ValueType>
+LayoutJobManager<Identifier, ValueType>::~LayoutJobManager() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+        if (pending_.has_value()) {
+            pending_->promise.set_value(nullopt);
+            pending_.reset();
+        }
+        running_token_.cancel();
+        condition_.wait(lock, [this] { return !running_; });
+    }
+}
+
+template<typename Identifier, typename ValueType>
+std::future<typename LayoutJobManager<Identifier, ValueType>::JobResult>
+LayoutJobManager<Identifier, ValueType>::submit(const Rect<ValueType>& frame) {
+    Job job{ frame, CancellationToken::make(), {}};
+    std::future<JobResult> future = job.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.has_value()) pending_->promise.set_value(nullopt);
+        running_token_.cancel();
+        pending_ = std::move(job);
+        // The running task picks up the new request when the cancelled layout has stopped.
+        if (running_) return future;
+        running_ = true;
+    }
+    if (executor_) executor_->execute([this] { run(); });
+    else run();
+    return future;
+}
+
+template<typename Identifier, typename ValueType>
+void LayoutJobManager<Identifier, ValueType>::run() {
+    while (true) {
+        optional<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || !pending_.has_value()) {
+                running_ = false;
+                condition_.notify_all();
+                return;
+            }
+            job = std::move(pending_);
+            pending_.reset();
+            running_token_ = job->token;
+        }
+
+        JobResult result;
+        // A failed layout, e.g. of a measurable that throws, fails its request and the manager goes on.
+        std::exception_ptr exception;
+        try {
+            result = compute(*job);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_token_ = {};
+        }
+        if (exception) job->promise.set_exception(std::move(exception));
+        else job->promise.set_value(std::move(result));
+    }
+}
+
+template<typename Identifier, typename ValueType>
+typename LayoutJobManager<Identifier, ValueType>::JobResult
+LayoutJobManager<Identifier, ValueType>::compute(const Job& job) const {
+    LayoutContext context;
+    context.set_cancellation_token(job.token);
+    LayoutContext::Scope scope(context);
+
+    LayoutResult<Identifier, ValueType> result = computer_.compute(job.frame);
+    if (context.interrupted()) return nullopt;
+    return result;
+}
+
+}
+
+#endif //VPACKCORE_LAYOUT_JOB_HPP
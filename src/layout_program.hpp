@@ -0,0 +1,582 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_LAYOUT_PROGRAM_HPP
+#define VPACKCORE_LAYOUT_PROGRAM_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "types.hpp"
+#include "computer.hpp"
+#include "layout_result.hpp"
+#include "layoutables/item.hpp"
+#include "layoutables/containers/stack_container.hpp"
+#include "layoutables/containers/vertical_container.hpp"
+#include "layoutables/containers/horizontal_container.hpp"
+
+namespace vpk::core {
+
+/// A layout tree compiled into two linear instruction streams, one that measures the tree and one that places it.
+///
+/// The structure of the tree, the parameters and the minimum and maximum sizes of its elements, and the order
+/// in which the containers measure their children are resolved when the program is compiled. Running the program
+/// walks the streams in a single loop over a flat table of the nodes, without recursion and without virtual calls
+/// on the containers, which makes it cheap to lay out a tree that is built once and laid out many times,
+/// e.g. the template of a list cell.
+///
+/// Items, horizontal, vertical and stack containers are compiled, any other element (e.g. a decorated container
+/// or a custom element) is kept as an opaque node that is measured and placed through its virtual functions.
+/// Items are measured through `Layoutable::measure`, so they keep their measurement caches.
+///
+/// The program produces the same result as `LayoutComputer::compute`. It has to be compiled again when the
+/// structure of the tree, the parameters of its elements or their minimum and maximum sizes change.
+/// Running a program is not thread-safe, it keeps its working memory between runs.
+template<typename Identifier, typename ValueType>
+class LayoutProgram {
+public:
+    enum class Op : uint8_t {
+        /* Measurement */
+
+        /// Calculates the size proposed to a node by its parent.
+        propose,
+        /// Measures a leaf or an opaque node with the proposed size.
+        measure,
+        /// Starts the measurement of a container with the proposed size.
+        begin,
+        /// Starts a priority group of a horizontal or vertical container, the operand is the number of its elements.
+        group,
+        /// Adds the size of the priority group to the size of the container.
+        end_group,
+        /// Completes the measurement of a container.
+        end,
+        /// Clamps the measured size of a node and adds it to its parent.
+        accept,
+
+        /* Placement */
+
+        /// Calculates the frame of a node within its parent.
+        place,
+        /// Writes the frame of a leaf to the result.
+        emit,
+        /// Places an opaque node and its descendants.
+        layout,
+        /// Starts the placement of the children of a container.
+        arrange,
+        /// Completes the placement of the children of a container.
+        end_arrange,
+    };
+
+    struct Instruction {
+        Op op;
+        /// The index of the node the instruction works on, or the count of a `group` instruction.
+        uint32_t operand;
+    };
+
+    /// Compiles the tree with the specified root.
+    explicit LayoutProgram(LayoutablePointer<Identifier, ValueType> root);
+
+    /// Computes the layout of the tree in the specified frame.
+    LayoutResult<Identifier, ValueType> run(const Rect<ValueType>& frame);
+
+    inline std::size_t node_count() const { return nodes_.size(); }
+
+    inline std::span<const Instruction> measure_program() const { return measure_program_; }
+
+    inline std::span<const Instruction> place_program() const { return place_program_; }
+
+private:
+    using Element = Layoutable<Identifier, ValueType>;
+    using HVContainer = detail::HVContainer<Identifier, ValueType>;
+    using AxisSize = detail::AxisSize<ValueType>;
+    using AxisPoint = detail::AxisPoint<ValueType>;
+
+    enum class NodeKind : uint8_t {
+        root,
+        leaf,
+        horizontal,
+        vertical,
+        stack,
+        opaque,
+    };
+
+    struct Node {
+        Element* element = nullptr;
+        /// The identifier of a leaf, null for anonymous leaves and all other nodes.
+        const Identifier* identifier = nullptr;
+        NodeKind kind = NodeKind::opaque;
+        /// The alignment of a horizontal or vertical container on its cross axis.
+        detail::AxisAlignment axis_alignment = detail::AxisAlignment::center;
+        /// The alignment of a stack container.
+        HorizontalAlignment horizontal_alignment = HorizontalAlignment::center;
+        VerticalAlignment vertical_alignment = VerticalAlignment::center;
+        EdgeInsets<ValueType> padding{};
+        Point<ValueType> offset{};
+        Size<ValueType> min_size{};
+        Size<ValueType> max_size{};
+        /// The padding and the limits of the node along the axes of its parent,
+        /// only set if the parent is a horizontal or vertical container.
+        detail::AxisEdgeInsets<ValueType> axis_padding{};
+        AxisSize axis_min_size{};
+        AxisSize axis_max_size{};
+    };
+
+    /// The state of a container while its children are measured, the sizes of horizontal and vertical containers
+    /// are along their axes.
+    struct MeasureFrame {
+        NodeKind kind = NodeKind::root;
+        uint32_t node = 0;
+        Size<ValueType> size{};
+        Size<ValueType> measured_size{};
+        AxisSize axis_size{};
+        AxisSize axis_measured_size{};
+        /// The space of the current priority group and the space its elements have taken so far.
+        AxisSize group_size{};
+        AxisSize group_measured_size{};
+        uint32_t group_count = 0;
+        uint32_t group_index = 0;
+        /// The space along the main axis the element being measured may take.
+        ValueType maximum_main = 0;
+    };
+
+    /// The state of a container while its children are placed.
+    struct PlaceFrame {
+        NodeKind kind = NodeKind::root;
+        uint32_t node = 0;
+        Point<ValueType> origin{};
+        Size<ValueType> size{};
+        AxisPoint axis_origin{};
+        AxisSize axis_size{};
+        ValueType used_main = 0;
+    };
+
+    LayoutablePointer<Identifier, ValueType> root_;
+    std::vector<Node> nodes_;
+    std::vector<Instruction> measure_program_;
+    std::vector<Instruction> place_program_;
+
+    /* The working memory of `run`. */
+
+    /// The size of each node as decided by its parent.
+    std::vector<Size<ValueType>> sizes_;
+    /// The measured size of the content of each container.
+    std::vector<Size<ValueType>> content_sizes_;
+    std::vector<MeasureFrame> measure_stack_;
+    std::vector<PlaceFrame> place_stack_;
+
+    /// Adds the node of the element and the nodes of its descendants in depth-first order.
+    ///
+    /// \param parent The parent of the element if it is a horizontal or vertical container.
+    /// \param children Receives the indices of the children of each node.
+    uint32_t add_node(const LayoutablePointer<Identifier, ValueType>& element, const HVContainer* parent,
+                      std::vector<std::vector<uint32_t>>& children);
+
+    void compile_measurement(uint32_t index, const std::vector<std::vector<uint32_t>>& children);
+
+    void compile_placement(uint32_t index, const std::vector<std::vector<uint32_t>>& children);
+
+    static inline bool is_axis_container(NodeKind kind) {
+        return kind == NodeKind::horizontal || kind == NodeKind::vertical;
+    }
+
+    static inline Size<ValueType> size_from_axis_size(NodeKind kind, const AxisSize& size) {
+        return kind == NodeKind::horizontal ? Size<ValueType>(size.main, size.cross)
+                                            : Size<ValueType>(size.cross, size.main);
+    }
+
+    static inline AxisSize axis_size_from_size(NodeKind kind, const Size<ValueType>& size) {
+        return kind == NodeKind::horizontal ? AxisSize(size.width, size.height) : AxisSize(size.height, size.width);
+    }
+
+    static inline Point<ValueType> point_from_axis_point(NodeKind kind, const AxisPoint& point) {
+        return kind == NodeKind::horizontal ? Point<ValueType>(point.main, point.cross)
+                                            : Point<ValueType>(point.cross, point.main);
+    }
+
+    static inline AxisPoint axis_point_from_point(NodeKind kind, const Point<ValueType>& point) {
+        return kind == NodeKind::horizontal ? AxisPoint(point.x, point.y) : AxisPoint(point.y, point.x);
+    }
+
+    /// The same as `Layoutable::preferred_size` with the limits of the node.
+    static inline Size<ValueType> preferred_size(const Node& node, const Size<ValueType>& size) {
+        return {
+            std::max<ValueType>(0, std::min(std::max(node.min_size.width, size.width), node.max_size.width)),
+            std::max<ValueType>(0, std::min(std::max(node.min_size.height, size.height), node.max_size.height)),
+        };
+    }
+
+    void measure(const Size<ValueType>& size);
+
+    void place(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result);
+};
+
+template<typename Identifier, typename ValueType>
+LayoutProgram<Identifier, ValueType>::LayoutProgram(LayoutablePointer<Identifier, ValueType> root)
+    : root_(std::move(root)) {
+    root_->resolve_node_kind();
+    std::vector<std::vector<uint32_t>> children;
+    const uint32_t root_index = add_node(root_, nullptr, children);
+    compile_measurement(root_index, children);
+    compile_placement(root_index, children);
+    sizes_.resize(nodes_.size());
+    content_sizes_.resize(nodes_.size());
+}
+
+template<typename Identifier, typename ValueType>
+uint32_t LayoutProgram<Identifier, ValueType>::add_node(const LayoutablePointer<Identifier, ValueType>& element,
+                                                        const HVContainer* parent,
+                                                        std::vector<std::vector<uint32_t>>& children) {
+    const auto index = static_cast<uint32_t>(nodes_.size());
+    Node node{
+        .element = element.get(),
+        .identifier = nullptr,
+        .kind = NodeKind::opaque,
+        .axis_alignment = detail::AxisAlignment::center,
+        .horizontal_alignment = HorizontalAlignment::center,
+        .vertical_alignment = VerticalAlignment::center,
+        .padding = element->padding(),
+        .offset = element->offset(),
+        .min_size = { element->min_width(), element->min_height() },
+        .max_size = { element->max_width(), element->max_height() },
+    };
+    if (parent) {
+        node.axis_padding = parent->axis_edge_insets_for_element(element);
+        node.axis_min_size = { parent->min_main_for_element(element), parent->min_cross_for_element(element) };
+        node.axis_max_size = { parent->max_main_for_element(element), parent->max_cross_for_element(element) };
+    }
+
+    // Only the exact types are compiled, a subclass may change how they measure or place their children.
+    const HVContainer* axis_container = nullptr;
+    switch (element->node_kind()) {
+        case detail::NodeKind::item: {
+            const auto& item = static_cast<const Item<Identifier, ValueType>&>(*element);
+            node.kind = NodeKind::leaf;
+            if (!item.anonymous()) node.identifier = &item.identifier();
+            break;
+        }
+        case detail::NodeKind::horizontal:
+        case detail::NodeKind::vertical:
+            axis_container = static_cast<const HVContainer*>(element.get());
+            node.kind = axis_container->horizontal() ? NodeKind::horizontal : NodeKind::vertical;
+            node.axis_alignment = axis_container->axis_alignment();
+            break;
+        case detail::NodeKind::stack: {
+            const auto& stack = static_cast<const StackContainer<Identifier, ValueType>&>(*element);
+            node.kind = NodeKind::stack;
+            node.horizontal_alignment = stack.alignment.horizontal();
+            node.vertical_alignment = stack.alignment.vertical();
+            break;
+        }
+        default:
+            break;
+    }
+    nodes_.push_back(node);
+    children.emplace_back();
+
+    if (node.kind == NodeKind::leaf || node.kind == NodeKind::opaque) return index;
+    std::vector<uint32_t> child_indices;
+    for (const auto& child: element->child_elements()) {
+        child_indices.push_back(add_node(child, axis_container, children));
+    }
+    children[index] = std::move(child_indices);
+    return index;
+}
+
+template<typename Identifier, typename ValueType>
+void LayoutProgram<Identifier, ValueType>::compile_measurement(uint32_t index,
+                                                               const std::vector<std::vector<uint32_t>>& children) {
+    const Node& node = nodes_[index];
+    measure_program_.push_back({ Op::propose, index });
+    switch (node.kind) {
+        case NodeKind::leaf:
+        case NodeKind::opaque:
+            measure_program_.push_back({ Op::measure, index });
+            break;
+        case NodeKind::horizontal:
+        case NodeKind::vertical: {
+            // The containers measure their priority groups in the order of the maximum sizes of the elements,
+            // which only depends on the tree.
+            const auto& container = static_cast<const HVContainer&>(*node.element);
+            measure_program_.push_back({ Op::begin, index });
+            for (std::size_t group = 0; group < container.priority_group_count(); ++group) {
+                const auto order = container.measure_order(group);
+                measure_program_.push_back({ Op::group, static_cast<uint32_t>(order.size()) });
+                for (const auto& [child, maximum_main]: order) {
+                    compile_measurement(children[index][child], children);
+                }
+                measure_program_.push_back({ Op::end_group, index });
+            }
+            measure_program_.push_back({ Op::end, index });
+            break;
+        }
+        case NodeKind::stack:
+            measure_program_.push_back({ Op::begin, index });
+            for (const uint32_t child: children[index]) {
+                compile_measurement(child, children);
+            }
+            measure_program_.push_back({ Op::end, index });
+            break;
+        case NodeKind::root:
+            break;
+    }
+    measure_program_.push_back({ Op::accept, index });
+}
+
+template<typename Identifier, typename ValueType>
+void LayoutProgram<Identifier, ValueType>::compile_placement(uint32_t index,
+                                                             const std::vector<std::vector<uint32_t>>& children) {
+    const Node& node = nodes_[index];
+    place_program_.push_back({ Op::place, index });
+    switch (node.kind) {
+        case NodeKind::leaf:
+            if (node.identifier) place_program_.push_back({ Op::emit, index });
+            break;
+        case NodeKind::opaque:
+            place_program_.push_back({ Op::layout, index });
+            break;
+        case NodeKind::horizontal:
+        case NodeKind::vertical:
+        case NodeKind::stack:
+            place_program_.push_back({ Op::arrange, index });
+            for (const uint32_t child: children[index]) {
+                compile_placement(child, children);
+            }
+            place_program_.push_back({ Op::end_arrange, index });
+            break;
+        case NodeKind::root:
+            break;
+    }
+}
+
+template<typename Identifier, typename ValueType>
+LayoutResult<Identifier, ValueType> LayoutProgram<Identifier, ValueType>::run(const Rect<ValueType>& frame) {
+    detail::MeasurePassScope pass;
+    LayoutResult<Identifier, ValueType> result;
+    measure(frame.size());
+    place(frame, result);
+    return result;
+}
+
+template<typename Identifier, typename ValueType>
+void LayoutProgram<Identifier, ValueType>::measure(const Size<ValueType>& size) {
+    Size<ValueType> proposed_size;
+    Size<ValueType> measured_size;
+    measure_stack_.clear();
+    // The root is measured like the root of `LayoutComputer::compute`, within the size of the frame.
+    measure_stack_.push_back({ .kind = NodeKind::root, .size = size });
+
+    for (const Instruction& instruction: measure_program_) {
+        MeasureFrame& parent = measure_stack_.back();
+        switch (instruction.op) {
+            case Op::propose: {
+                const Node& node = nodes_[instruction.operand];
+                if (is_axis_container(parent.kind)) {
+                    // The remaining elements of the group share the remaining space equally.
+                    const auto count = static_cast<ValueType>(parent.group_count - parent.group_index);
+                    parent.maximum_main = (parent.group_size.main - parent.group_measured_size.main) / count;
+                    proposed_size = size_from_axis_size(parent.kind, AxisSize{
+                        std::min(parent.maximum_main - node.axis_padding.main(), node.axis_max_size.main),
+                        std::min(parent.group_size.cross - node.axis_padding.cross(), node.axis_max_size.cross)
+                    });
+                } else {
+                    proposed_size = preferred_size(node, {
+                        parent.size.width - node.padding.horizontal(),
+                        parent.size.height - node.padding.vertical()
+                    });
+                }
+                break;
+            }
+            case Op::measure:
+                measured_size = nodes_[instruction.operand].element->measure(proposed_size);
+                break;
+            case Op::begin: {
+                const NodeKind kind = nodes_[instruction.operand].kind;
+                measure_stack_.push_back({
+                    .kind = kind,
+                    .node = instruction.operand,
+                    .size = proposed_size,
+                    .axis_size = is_axis_container(kind) ? axis_size_from_size(kind, proposed_size) : AxisSize(),
+                });
+                break;
+            }
+            case Op::group:
+                parent.group_size = {
+                    std::max<ValueType>(0, parent.axis_size.main - parent.axis_measured_size.main),
+                    parent.axis_size.cross
+                };
+                parent.group_measured_size = {};
+                parent.group_count = instruction.operand;
+                parent.group_index = 0;
+                break;
+            case Op::end_group:
+                parent.axis_measured_size.main += parent.group_measured_size.main;
+                parent.axis_measured_size.cross = std::max(parent.group_measured_size.cross,
+                                                           parent.axis_measured_size.cross);
+                break;
+            case Op::end:
+                measured_size = is_axis_container(parent.kind)
+                                ? size_from_axis_size(parent.kind, parent.axis_measured_size)
+                                : parent.measured_size;
+                content_sizes_[parent.node] = measured_size;
+                measure_stack_.pop_back();
+                break;
+            case Op::accept: {
+                const Node& node = nodes_[instruction.operand];
+                if (is_axis_container(parent.kind)) {
+                    const AxisSize item_size = axis_size_from_size(parent.kind, measured_size);
+                    const detail::AxisEdgeInsets<ValueType>& padding = node.axis_padding;
+                    const ValueType main = std::max(node.axis_min_size.main,
+                                                    std::min(item_size.main, parent.maximum_main - padding.main()));
+                    const ValueType cross = std::max(node.axis_min_size.cross,
+                                                     std::min(item_size.cross,
+                                                              parent.group_size.cross - padding.cross()));
+                    sizes_[instruction.operand] = size_from_axis_size(parent.kind, AxisSize{ main, cross });
+                    parent.group_measured_size.main += (main + padding.main());
+                    parent.group_measured_size.cross = std::max(parent.group_measured_size.cross,
+                                                                 cross + padding.cross());
+                    parent.group_index += 1;
+                } else {
+                    const Size<ValueType> item_size = preferred_size(node, measured_size);
+                    sizes_[instruction.operand] = item_size;
+                    parent.measured_size = {
+                        std::max(item_size.width + node.padding.horizontal(), parent.measured_size.width),
+                        std::max(item_size.height + node.padding.vertical(), parent.measured_size.height)
+                    };
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+template<typename Identifier, typename ValueType>
+void LayoutProgram<Identifier, ValueType>::place(const Rect<ValueType>& frame,
+                                                 LayoutResult<Identifier, ValueType>& result) {
+    Rect<ValueType> node_frame;
+    place_stack_.clear();
+    place_stack_.push_back({ .kind = NodeKind::root });
+
+    for (const Instruction& instruction: place_program_) {
+        PlaceFrame& parent = place_stack_.back();
+        const Node& node = nodes_[instruction.operand];
+        switch (instruction.op) {
+            case Op::place: {
+                const Size<ValueType>& item_size = sizes_[instruction.operand];
+                if (parent.kind == NodeKind::root) {
+                    node_frame = detail::root_frame(*node.element, frame, item_size);
+                } else if (is_axis_container(parent.kind)) {
+                    const AxisSize axis_item_size = axis_size_from_size(parent.kind, item_size);
+                    const detail::AxisEdgeInsets<ValueType>& padding = node.axis_padding;
+                    const AxisSize item_container_size = {
+                        axis_item_size.main + padding.main(),
+                        axis_item_size.cross + padding.cross()
+                    };
+                    const ValueType cross_offset = [&]() -> ValueType {
+                        switch (nodes_[parent.node].axis_alignment) {
+                            case detail::AxisAlignment::start:
+                                return 0;
+                            case detail::AxisAlignment::center:
+                                return (parent.axis_size.cross - item_container_size.cross) / 2;
+                            case detail::AxisAlignment::end:
+                                return parent.axis_size.cross - item_container_size.cross;
+                        }
+                        return 0;
+                    }();
+                    const AxisPoint item_offset = axis_point_from_point(parent.kind, node.offset);
+                    node_frame = Rect<ValueType>(
+                        point_from_axis_point(parent.kind, AxisPoint{
+                            parent.axis_origin.main + parent.used_main + item_offset.main + padding.main_start,
+                            parent.axis_origin.cross + cross_offset + item_offset.cross + padding.cross_start
+                        }),
+                        item_size
+                    );
+                    parent.used_main += item_container_size.main;
+                } else {
+                    // Every child of a stack is lifted above the previous ones.
+                    result.max_z_idx += 1;
+                    const Node& stack = nodes_[parent.node];
+                    const EdgeInsets<ValueType>& padding = node.padding;
+                    const Size<ValueType> item_container_size = {
+                        item_size.width + padding.horizontal(),
+                        item_size.height + padding.vertical()
+                    };
+                    const ValueType x_offset = [&]() -> ValueType {
+                        switch (stack.horizontal_alignment) {
+                            case HorizontalAlignment::leading:
+                                return 0;
+                            case HorizontalAlignment::center:
+                                return (parent.size.width - item_container_size.width) / 2;
+                            case HorizontalAlignment::trailing:
+                                return parent.size.width - item_container_size.width;
+                        }
+                        return 0;
+                    }();
+                    const ValueType y_offset = [&]() -> ValueType {
+                        switch (stack.vertical_alignment) {
+                            case VerticalAlignment::top:
+                                return 0;
+                            case VerticalAlignment::center:
+                                return (parent.size.height - item_container_size.height) / 2;
+                            case VerticalAlignment::bottom:
+                                return parent.size.height - item_container_size.height;
+                        }
+                        return 0;
+                    }();
+                    node_frame = {
+                        parent.origin.x + x_offset + padding.left + node.offset.x,
+                        parent.origin.y + y_offset + padding.top + node.offset.y,
+                        item_size.width,
+                        item_size.height,
+                    };
+                }
+                break;
+            }
+            case Op::emit:
+                result.map.insert_or_assign(
+                    *node.identifier, LayoutAttributes<ValueType>{ .frame = node_frame, .z_idx = result.max_z_idx }
+                );
+                break;
+            case Op::layout:
+                node.element->layout(node_frame, result);
+                break;
+            case Op::arrange: {
+                // The children are laid out in terms of the space they occupy, centered in the frame.
+                const Size<ValueType>& content_size = content_sizes_[instruction.operand];
+                const Point<ValueType> origin = {
+                    node_frame.x + (node_frame.width - content_size.width) / 2,
+                    node_frame.y + (node_frame.height - content_size.height) / 2
+                };
+                const Size<ValueType> size = {
+                    std::max(node_frame.width, content_size.width),
+                    std::max(node_frame.height, content_size.height)
+                };
+                const bool axis = is_axis_container(node.kind);
+                place_stack_.push_back({
+                    .kind = node.kind,
+                    .node = instruction.operand,
+                    .origin = origin,
+                    .size = size,
+                    .axis_origin = axis ? axis_point_from_point(node.kind, origin) : AxisPoint(),
+                    .axis_size = axis ? axis_size_from_size(node.kind, size) : AxisSize(),
+                    .used_main = 0,
+                });
+                break;
+            }
+            case Op::end_arrange:
+                place_stack_.pop_back();
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+}
+
+#endif //VPACKCORE_LAYOUT_PROGRAM_HPP
@@ -47,7 +47,7 @@ bool
 operator ==(const LayoutResult<Identifier, ValueType>& r1, const LayoutResult<Identifier, ValueType>& r2) noexcept {
     if (r1.max_z_idx != r2.max_z_idx) return false;
     if (r1.map.size() != r2.map.size()) return false;
-    return std::all_of(r1.map.begin(), r2.map.end(), [&r2](const auto& it) {
+    return std::all_of(r1.map.begin(), r1.map.end(), [&r2](const auto& it) {
         const auto iter = r2.map.find(it.first);
         if (iter == r2.map.end()) return false;
         if (iter->second != it.second) return false;
@@ -0,0 +1,64 @@
+//
+// Created by ktiays on 2022/9/13.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_BATCH_MEASURABLE_HPP
+#define VPACKCORE_BATCH_MEASURABLE_HPP
+
+#include <span>
+#include <memory>
+
+#include "measurable.hpp"
+
+namespace vpk::core {
+
+template<typename ValueType>
+class BatchMeasurable;
+
+/// One measurement of a batch passed to `BatchMeasurer::measure_batch`.
+template<typename ValueType>
+struct BatchMeasureRequest {
+    const BatchMeasurable<ValueType>* measurable;
+    Size<ValueType> proposed_size;
+    /// Written by the measurer.
+    Size<ValueType> measured_size;
+};
+
+/// Measures the content of many measurables at once, e.g. a text measurer that shapes all strings
+/// of a batch with one font lookup.
+template<typename ValueType>
+class BatchMeasurer {
+public:
+    /// Writes the measured size of every request.
+    virtual void measure_batch(std::span<BatchMeasureRequest<ValueType>> requests) const = 0;
+
+    virtual ~BatchMeasurer() = default;
+};
+
+/// A measurable whose measurements can be batched with the measurements of other measurables
+/// that share its measurer.
+///
+/// Containers collect the measurements of the batch measurables among their children and pass them
+/// to the measurers together. A measurement outside of a batch is a batch of one.
+template<typename ValueType>
+class BatchMeasurable : public Measurable<ValueType> {
+public:
+    explicit BatchMeasurable(std::shared_ptr<const BatchMeasurer<ValueType>> measurer)
+        : measurer_(std::move(measurer)) {}
+
+    inline const BatchMeasurer<ValueType>* batch_measurer() const { return measurer_.get(); }
+
+    Size<ValueType> measure(const Size<ValueType>& size) const override {
+        BatchMeasureRequest<ValueType> request{ this, size, {}};
+        measurer_->measure_batch({ &request, 1 });
+        return request.measured_size;
+    }
+
+private:
+    std::shared_ptr<const BatchMeasurer<ValueType>> measurer_;
+};
+
+}
+
+#endif //VPACKCORE_BATCH_MEASURABLE_HPP
@@ -6,62 +6,169 @@
 #ifndef VPACKCORE_CONTAINER_HPP
 #define VPACKCORE_CONTAINER_HPP
 
-#include <map>
+#include <span>
 #include <vector>
+#include <numeric>
 #include <utility>
 #include <algorithm>
 
+#include "leaf_batch.hpp"
 #include "../layoutable.hpp"
 #include "../../utils/indexed.hpp"
+#include "../../utils/small_vector.hpp"
 #include "../utils/size_extractor.hpp"
 
-#define __DEAL_MIN_WIDTH_ELSE(property) \
-if (size_property.property.has_value()) this->property##_ = *size_property.property; \
-else this->property##_ =
+#ifndef VPACKCORE_CONTAINER_INLINE_CAPACITY
+#define VPACKCORE_CONTAINER_INLINE_CAPACITY 4
+#endif
 
-#define __DEAL_SIZE_FOR_POLICY_WITH_PROPERTY(property, policy) \
-__DEAL_MIN_WIDTH_ELSE(property) calculate_min_max_dimension<SizeExtractor::property, Identifier, ValueType>(children, policy)
+namespace vpk::core {
 
-#define __DEAL_MIN_WIDTH_FOR_POLICY(policy) __DEAL_SIZE_FOR_POLICY_WITH_PROPERTY(min_width, policy)
-#define __DEAL_MAX_WIDTH_FOR_POLICY(policy) __DEAL_SIZE_FOR_POLICY_WITH_PROPERTY(max_width, policy)
-#define __DEAL_MIN_HEIGHT_FOR_POLICY(policy) __DEAL_SIZE_FOR_POLICY_WITH_PROPERTY(min_height, policy)
-#define __DEAL_MAX_HEIGHT_FOR_POLICY(policy) __DEAL_SIZE_FOR_POLICY_WITH_PROPERTY(max_height, policy)
+/// The number of child elements up to which a container keeps its per-child arrays inside itself,
+/// set by `VPACKCORE_CONTAINER_INLINE_CAPACITY`.
+///
+/// Most containers have a few children, these need no allocations besides the container itself.
+inline constexpr std::size_t container_inline_capacity = VPACKCORE_CONTAINER_INLINE_CAPACITY;
 
-namespace vpk::core {
+template<typename Identifier, typename ValueType>
+class LayoutProgram;
+
+/// An array with one entry per child element of a container.
+template<typename T>
+using ChildArray = SmallVector<T, container_inline_capacity>;
+
+namespace detail {
+
+/// The sizes of the child elements in the code shared by the measurement and the affine measurement,
+/// whose storage differs between the two. The size type is never deduced from the list.
+template<typename Scalar>
+using SizeList = std::type_identity_t<std::span<Size<Scalar>>>;
+
+template<typename Scalar>
+using ConstSizeList = std::type_identity_t<std::span<const Size<Scalar>>>;
+
+}
 
 template<typename Identifier, typename ValueType>
 class Container : public Layoutable<Identifier, ValueType> {
 private:
     using ElementPointer = LayoutablePointer<Identifier, ValueType>;
-    using ElementListType = std::vector<ElementPointer>;
+    using ElementListType = ChildArray<ElementPointer>;
     using ElementSizeType = typename ElementListType::size_type;
 
 public:
-    Container(const std::vector<LayoutablePointer<Identifier, ValueType>>& items, const LayoutParams<ValueType>& params)
-        : Layoutable<Identifier, ValueType>(params), children(items) {
-        size_list.resize(items.size());
+    /// \param width_policy How the widths of the child elements are combined into the width of the container.
+    /// \param height_policy How the heights of the child elements are combined into the height of the container.
+    ///
+    /// The child elements are moved into the container, pass an rvalue to create it without copying the pointers.
+    Container(std::vector<LayoutablePointer<Identifier, ValueType>> items, const LayoutParams<ValueType>& params,
+              MinMaxPolicy width_policy, MinMaxPolicy height_policy)
+        : Layoutable<Identifier, ValueType>(params),
+          children(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end())),
+          width_policy_(width_policy), height_policy_(height_policy) {
+        measure_states_[0].size_list.resize(children.size());
 
-        for (auto it: makeIndexed(items)) {
-            const ElementPointer& ptr = it.value();
-            children_priority_map[ptr->params.priority].push_back(std::make_pair(it.index(), ptr));
+        bool single_priority = true;
+        for (const ElementPointer& ptr: children) {
+            ptr->resolve_node_kind();
+            this->adopt(*ptr);
+            single_priority = single_priority && ptr->params().priority == children.front()->params().priority;
+            this->subtree_size_ += ptr->subtree_size();
+            this->subtree_lifts_ += ptr->subtree_lifts();
+            if (ptr->batch_measurable()) batchable_children += 1;
         }
+        group_by_priority(single_priority);
     }
 
+    ~Container() override {
+        for (const ElementPointer& ptr: children) {
+            this->release(*ptr);
+        }
+    }
+
+    std::span<const ElementPointer> child_elements() const override { return children; }
+
 protected:
     ElementListType children;
-    /// A map that sorts the child elements by layout priority.
-    ///
-    /// The map is sorted in descending order of priority.
-    std::map<int, std::vector<std::pair<ElementSizeType, ElementPointer>>, std::greater<int>> children_priority_map;
-    // The size list of the element calculated by the cache.
-    // The size indicates the actual display size of the element, i.e., the size without padding.
-    std::vector<Size<ValueType>> size_list;
+    /// The indices of the child elements sorted in descending order of layout priority,
+    /// in the order of the children within a priority.
+    ChildArray<ElementSizeType> priority_order;
+    /// The offsets of the groups of child elements with the same priority in `priority_order`,
+    /// followed by the number of child elements. There are two offsets when all children share a priority.
+    SmallVector<ElementSizeType, 2> priority_group_offsets;
+    /// The number of child elements that can be measured in a batch.
+    ElementSizeType batchable_children = 0;
 
-    /// A cache of the results of the last size calculation.
+    /// The state that a measurement prepares for the following layout.
+    struct MeasureState {
+        // The size list of the element calculated by the cache.
+        // The size indicates the actual display size of the element, i.e., the size without padding.
+        ChildArray<Size<ValueType>> size_list;
+
+        /// A cache of the results of the last size calculation.
+        ///
+        /// It represents the actual total size that all child elements need to occupy.
+        /// Default value of this property is 0.
+        Size<ValueType> cached_measured_size;
+    };
+
+    /// The measurement state of the buffer selected by the context installed on the current thread.
     ///
-    /// It represents the actual total size that all child elements need to occupy.
-    /// Default value of this property is 0.
-    Size<ValueType> cached_measured_size;
+    /// The states of the buffers besides the first one are created empty, their size lists are sized
+    /// when they are first measured into.
+    inline MeasureState& measure_state() {
+        MeasureState& state = measure_states_[detail::current_measure_buffer()];
+        if (state.size_list.size() != children.size()) state.size_list.resize(children.size());
+        return state;
+    }
+
+    inline const MeasureState& measure_state() const { return measure_states_[detail::current_measure_buffer()]; }
+
+    /// Combines the minimum and maximum sizes of the child elements by the policies of the container,
+    /// the size property overrides the combined sizes.
+    IntrinsicSize<ValueType> calculate_intrinsic_size() const override {
+        const SizeProperty<ValueType>& size_property = this->params().size_property;
+        const IntrinsicSize<ValueType> size = vpk::core::calculate_intrinsic_size<Identifier, ValueType>(
+            children, width_policy_, height_policy_);
+        return {
+            { size_property.min_width.value_or(size.min.width), size_property.min_height.value_or(size.min.height) },
+            { size_property.max_width.value_or(size.max.width), size_property.max_height.value_or(size.max.height) },
+        };
+    }
+
+    inline std::size_t priority_group_count() const { return priority_group_offsets.size() - 1; }
+
+    /// The indices of the child elements in a group of the same priority,
+    /// the groups are sorted in descending order of priority.
+    inline std::span<const ElementSizeType> priority_group(std::size_t group) const {
+        return std::span(priority_order).subspan(priority_group_offsets[group],
+                                                 priority_group_offsets[group + 1] - priority_group_offsets[group]);
+    }
+
+private:
+    detail::MeasureBuffers<MeasureState> measure_states_;
+    MinMaxPolicy width_policy_;
+    MinMaxPolicy height_policy_;
+
+    void group_by_priority(bool single_priority) {
+        priority_order.resize(children.size());
+        std::iota(priority_order.begin(), priority_order.end(), 0);
+        priority_group_offsets.reserve(single_priority ? 2 : children.size() + 1);
+        priority_group_offsets.push_back(0);
+        // Almost all containers have a single priority, which needs no sorting.
+        if (!single_priority) {
+            std::stable_sort(priority_order.begin(), priority_order.end(), [this](auto a, auto b) {
+                return children[a]->params().priority > children[b]->params().priority;
+            });
+            for (ElementSizeType i = 1; i < priority_order.size(); ++i) {
+                const int priority = children[priority_order[i]]->params().priority;
+                if (priority != children[priority_order[i - 1]]->params().priority) {
+                    priority_group_offsets.push_back(i);
+                }
+            }
+        }
+        if (!children.empty()) priority_group_offsets.push_back(children.size());
+    }
 };
 
 }
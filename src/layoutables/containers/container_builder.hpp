@@ -0,0 +1,77 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_CONTAINER_BUILDER_HPP
+#define VPACKCORE_CONTAINER_BUILDER_HPP
+
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "../layoutable.hpp"
+
+namespace vpk::core {
+
+/// Collects the child elements of a container and creates the container with them.
+///
+/// The elements are created in the storage of the builder and moved into the container,
+/// so building a tree copies no pointer to an element.
+///
+/// \code
+/// auto stack = ContainerBuilder<Identifier, ValueType>()
+///     .emplace<Item<Identifier, ValueType>>(identifier, params, measurable)
+///     .add(std::move(child))
+///     .build<HorizontalContainer<Identifier, ValueType>>(params, VerticalAlignment::center);
+/// \endcode
+template<typename Identifier, typename ValueType>
+class ContainerBuilder {
+public:
+    using ElementPointer = LayoutablePointer<Identifier, ValueType>;
+
+    ContainerBuilder() = default;
+
+    /// \param capacity The number of child elements the builder reserves storage for.
+    explicit ContainerBuilder(std::size_t capacity) {
+        children_.reserve(capacity);
+    }
+
+    /// Adds a child element.
+    ContainerBuilder& add(ElementPointer element) & {
+        children_.push_back(std::move(element));
+        return *this;
+    }
+
+    ContainerBuilder&& add(ElementPointer element) && { return std::move(add(std::move(element))); }
+
+    /// Creates a child element of the specified type with the arguments and adds it.
+    template<typename Element, typename... Args>
+    ContainerBuilder& emplace(Args&& ... args) & {
+        children_.push_back(make_layoutable<Element>(std::forward<Args>(args)...));
+        return *this;
+    }
+
+    template<typename Element, typename... Args>
+    ContainerBuilder&& emplace(Args&& ... args) && {
+        return std::move(emplace<Element>(std::forward<Args>(args)...));
+    }
+
+    inline std::size_t size() const { return children_.size(); }
+
+    /// Creates a container of the specified type with the child elements that have been added,
+    /// which leaves the builder empty.
+    ///
+    /// \param args The arguments of the constructor of the container that follow the child elements.
+    template<typename ContainerType, typename... Args>
+    detail::NodePointer<ContainerType> build(Args&& ... args) {
+        return make_layoutable<ContainerType>(std::exchange(children_, {}), std::forward<Args>(args)...);
+    }
+
+private:
+    std::vector<ElementPointer> children_;
+};
+
+}
+
+#endif //VPACKCORE_CONTAINER_BUILDER_HPP
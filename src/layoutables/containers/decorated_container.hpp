@@ -15,18 +15,6 @@ enum class DecoratedStyle {
     overlay,
 };
 
-#define DEAL_CONTENT_ELEMENT_WITH(property, direction) \
-__DEAL_MIN_WIDTH_ELSE(property) content->property() + padding.direction()
-
-#define DEAL_DECORATED_SIZE_PROPERTY \
-const SizeProperty<ValueType> size_property = params.size_property; \
-const auto content = content_element();                             \
-const EdgeInsets<ValueType> padding = content_element()->padding(); \
-DEAL_CONTENT_ELEMENT_WITH(min_width, horizontal);                   \
-DEAL_CONTENT_ELEMENT_WITH(max_width, horizontal);                   \
-DEAL_CONTENT_ELEMENT_WITH(min_height, vertical);                    \
-DEAL_CONTENT_ELEMENT_WITH(max_height, vertical)
-
 /// A container for handling decorated views.
 ///
 /// The container contains only 2 elements, one for the content element and the other for the decorated view.
@@ -34,19 +22,49 @@ DEAL_CONTENT_ELEMENT_WITH(max_height, vertical)
 template<typename Identifier, typename ValueType>
 class DecoratedContainer : public StackContainer<Identifier, ValueType> {
 public:
-    DecoratedContainer(const std::vector<LayoutablePointer<Identifier, ValueType>>& children,
+    DecoratedContainer(std::vector<LayoutablePointer<Identifier, ValueType>> children,
                        const LayoutParams<ValueType>& params,
                        const DecoratedStyle& decorated_style)
-        : StackContainer<Identifier, ValueType>(children, params, Alignment::center),
+        : StackContainer<Identifier, ValueType>(std::move(children), params, Alignment::center),
           decorated_style_(decorated_style) {
-        assert(children.size() == 2);
+        assert(this->children.size() == 2);
+    }
 
-        DEAL_DECORATED_SIZE_PROPERTY;
+    DecoratedContainer(std::span<const LayoutablePointer<Identifier, ValueType>> children,
+                       const LayoutParams<ValueType>& params,
+                       const DecoratedStyle& decorated_style)
+        : DecoratedContainer(std::vector(children.begin(), children.end()), params, decorated_style) {}
+
+    Size<Affine<ValueType>> measure_affine(const Size<Affine<ValueType>>& size,
+                                           detail::AffinePass<Identifier, ValueType>& pass) override;
+
+protected:
+    Size<ValueType> measure_content(const Size<ValueType>& size) override;
+
+    /// The sizes of the content element including its padding, the size property overrides them.
+    IntrinsicSize<ValueType> calculate_intrinsic_size() const override {
+        const SizeProperty<ValueType>& size_property = this->params().size_property;
+        const Element& content = content_element();
+        const EdgeInsets<ValueType> padding = content->padding();
+        return {
+            {
+                size_property.min_width.value_or(content->min_width() + padding.horizontal()),
+                size_property.min_height.value_or(content->min_height() + padding.vertical()),
+            },
+            {
+                size_property.max_width.value_or(content->max_width() + padding.horizontal()),
+                size_property.max_height.value_or(content->max_height() + padding.vertical()),
+            },
+        };
     }
 
-    Size<ValueType> measure(const Size<ValueType>& size) override;
+    detail::NodeKind exact_node_kind() const override {
+        return detail::kind_if_exact(*this, detail::NodeKind::decorated);
+    }
 
 private:
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
     /// An enumeration value specifying which of the two elements is the decorated view.
     DecoratedStyle decorated_style_;
 
@@ -65,49 +83,84 @@ private:
     const Element& decorated_element() const {
         return this->children.at(content_index() ^ 1);
     }
+
+    /// Measures the elements, shared by the measurement and the affine measurement.
+    ///
+    /// \param size_list The list that receives the sizes of the elements.
+    /// \param measure Measures an element, called with the element and the proposed size.
+    /// \return The size of the wrapped content element.
+    template<typename Scalar, typename MeasureFunction>
+    Size<Scalar> measure_children(const Size<Scalar>& size, detail::SizeList<Scalar> size_list,
+                                  MeasureFunction&& measure);
 };
 
-#undef DEAL_DECORATED_SIZE_PROPERTY
-#undef DEAL_CONTENT_ELEMENT_WITH
 
 template<typename Identifier, typename ValueType>
-Size<ValueType> DecoratedContainer<Identifier, ValueType>::measure(const Size<ValueType>& size) {
+Size<ValueType> DecoratedContainer<Identifier, ValueType>::measure_content(const Size<ValueType>& size) {
+    auto& state = this->measure_state();
+    state.cached_measured_size = measure_children(
+        size, state.size_list,
+        [](const Element& child, const Size<ValueType>& proposed_size) { return child->measure(proposed_size); }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+Size<Affine<ValueType>>
+DecoratedContainer<Identifier, ValueType>::measure_affine(const Size<Affine<ValueType>>& size,
+                                                          detail::AffinePass<Identifier, ValueType>& pass) {
+    auto& state = pass.measure_state(*this);
+    state.size_list.resize(this->children.size());
+    state.cached_measured_size = measure_children(
+        size, state.size_list,
+        [&pass](const Element& child, const Size<Affine<ValueType>>& proposed_size) {
+            return child->measure_affine(proposed_size, pass);
+        }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+template<typename Scalar, typename MeasureFunction>
+Size<Scalar> DecoratedContainer<Identifier, ValueType>::measure_children(const Size<Scalar>& size,
+                                                                         detail::SizeList<Scalar> size_list,
+                                                                         MeasureFunction&& measure) {
+    using detail::min, detail::max;
     using usize = typename decltype(this->children)::size_type;
     const usize content_index = this->content_index();
 
     const auto& content = content_element();
     const EdgeInsets<ValueType> content_padding = content->padding();
     // The size of the container used to calculate the content view.
-    const Size<ValueType> content_container_size = {
-        std::max(content->min_width(), std::min(size.width - content_padding.horizontal(), content->max_width())),
-        std::max(content->min_height(), std::min(size.height - content_padding.vertical(), content->max_height())),
+    const Size<Scalar> content_container_size = {
+        max<Scalar>(content->min_width(), min<Scalar>(size.width - content_padding.horizontal(), content->max_width())),
+        max<Scalar>(content->min_height(), min<Scalar>(size.height - content_padding.vertical(), content->max_height())),
     };
-    Size<ValueType> content_size = content->measure(content_container_size);
+    Size<Scalar> content_size = measure(content, content_container_size);
     content_size = {
-        std::min(std::max(content->min_width(), content_size.width), content_container_size.width),
-        std::min(std::max(content->min_height(), content_size.height), content_container_size.height)
+        min<Scalar>(max<Scalar>(content->min_width(), content_size.width), content_container_size.width),
+        min<Scalar>(max<Scalar>(content->min_height(), content_size.height), content_container_size.height)
     };
     // The size of the wrapped content view, i.e. the size of the element after adding padding.
     //
     // When calculating the size of a container, it is based on the total size occupied by the element,
     // not the actual size rendered by the element.
-    const Size<ValueType> wrapped_content_size = {
+    const Size<Scalar> wrapped_content_size = {
         content_size.width + content_padding.horizontal(),
         content_size.height + content_padding.vertical()
     };
-    this->size_list.at(content_index) = content_size;
-    this->cached_measured_size = wrapped_content_size;
+    size_list[content_index] = content_size;
 
     const auto& decorated = this->decorated_element();
     const EdgeInsets<ValueType> decorated_padding = decorated->padding();
     // Use the size of the content element as the container size of the decorated view.
-    Size<ValueType> decorated_size = decorated->measure({
-                                                            wrapped_content_size.width - decorated_padding.horizontal(),
-                                                            wrapped_content_size.height - decorated_padding.vertical()
-                                                        });
-    this->size_list.at(content_index ^ 1) = {
-        std::min(std::max(decorated->min_width(), decorated_size.width), decorated->max_width()),
-        std::min(std::max(decorated->min_height(), decorated_size.height), decorated->max_height()),
+    Size<Scalar> decorated_size = measure(decorated, Size<Scalar>{
+        wrapped_content_size.width - decorated_padding.horizontal(),
+        wrapped_content_size.height - decorated_padding.vertical()
+    });
+    size_list[content_index ^ 1] = {
+        min<Scalar>(max<Scalar>(decorated->min_width(), decorated_size.width), decorated->max_width()),
+        min<Scalar>(max<Scalar>(decorated->min_height(), decorated_size.height), decorated->max_height()),
     };
 
     return wrapped_content_size;
@@ -16,21 +16,19 @@ namespace vpk::core {
 template<typename Identifier, typename ValueType>
 class HorizontalContainer : public detail::HVContainer<Identifier, ValueType> {
 public:
-    HorizontalContainer(const std::vector<LayoutablePointer<Identifier, ValueType>>& children,
+    HorizontalContainer(std::vector<LayoutablePointer<Identifier, ValueType>> children,
                         const LayoutParams<ValueType>& params, VerticalAlignment align)
-        : detail::HVContainer<Identifier, ValueType>(children, params), alignment(align) {
-        const SizeProperty<ValueType> size_property = params.size_property;
-        __DEAL_MIN_WIDTH_FOR_POLICY(MinMaxPolicy::sum);
-        __DEAL_MAX_WIDTH_FOR_POLICY(MinMaxPolicy::sum);
-        __DEAL_MIN_HEIGHT_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MAX_HEIGHT_FOR_POLICY(MinMaxPolicy::max);
-    }
+        : detail::HVContainer<Identifier, ValueType>(std::move(children), params, MinMaxPolicy::sum, MinMaxPolicy::max),
+          alignment(align) {}
+
+    HorizontalContainer(std::span<const LayoutablePointer<Identifier, ValueType>> children,
+                        const LayoutParams<ValueType>& params, VerticalAlignment align)
+        : HorizontalContainer(std::vector(children.begin(), children.end()), params, align) {}
 
     using Element = typename detail::HVContainer<Identifier, ValueType>::Element;
 
     detail::AxisEdgeInsets<ValueType> axis_edge_insets_for_element(Element element) const override {
-        const EdgeInsets<ValueType> padding = element->padding();
-        return { padding.left, padding.right, padding.top, padding.bottom };
+        return detail::axis_edge_insets_from_padding(element->padding());
     }
 
     ValueType min_main_for_element(Element element) const override { return element->min_width(); }
@@ -41,21 +39,7 @@ public:
 
     ValueType max_cross_for_element(Element element) const override { return element->max_height(); }
 
-    Point <ValueType> point_from_axis_point(const detail::AxisPoint<ValueType>& point) const override {
-        return { point.main, point.cross };
-    }
-
-    detail::AxisPoint<ValueType> axis_point_from_point(const Point <ValueType>& point) const override {
-        return { point.x, point.y };
-    }
-
-    Size<ValueType> size_from_axis_size(const detail::AxisSize<ValueType>& size) const override {
-        return { size.main, size.cross };
-    };
-
-    detail::AxisSize<ValueType> axis_size_from_size(const Size<ValueType>& size) const override {
-        return { size.width, size.height };
-    };
+    bool horizontal() const override { return true; }
 
     detail::AxisAlignment axis_alignment() const override {
         switch (alignment) {
@@ -66,9 +50,17 @@ public:
             case VerticalAlignment::bottom:
                 return detail::AxisAlignment::end;
         }
+        return detail::AxisAlignment::start;
+    }
+
+protected:
+    detail::NodeKind exact_node_kind() const override {
+        return detail::kind_if_exact(*this, detail::NodeKind::horizontal);
     }
 
 private:
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
     VerticalAlignment alignment;
 
 };
@@ -58,11 +58,17 @@ struct AxisEdgeInsets {
     }
 };
 
+/// The insets of an element along the axes of the horizontal and vertical containers of the library.
+template<typename ValueType>
+inline AxisEdgeInsets<ValueType> axis_edge_insets_from_padding(const EdgeInsets<ValueType>& padding) {
+    return { padding.left, padding.right, padding.top, padding.bottom };
+}
+
 template<typename Identifier, typename ValueType>
 struct HVContainer : public vpk::core::Container<Identifier, ValueType> {
-    HVContainer(const std::vector<LayoutablePointer<Identifier, ValueType>>& items,
-                const LayoutParams<ValueType>& params)
-        : vpk::core::Container<Identifier, ValueType>(items, params) {}
+    HVContainer(std::vector<LayoutablePointer<Identifier, ValueType>> items,
+                const LayoutParams<ValueType>& params, MinMaxPolicy width_policy, MinMaxPolicy height_policy)
+        : vpk::core::Container<Identifier, ValueType>(std::move(items), params, width_policy, height_policy) {}
 
 protected:
     using Element = LayoutablePointer<Identifier, ValueType>;
@@ -89,150 +95,368 @@ protected:
     /// The alignment of the container on the main axis.
     virtual AxisAlignment axis_alignment() const = 0;
 
-    /// Convert from cross-axis point to regular point.
+    /// Whether the main axis of the container is the horizontal axis.
     ///
     /// This method needs to be implemented by a subclass.
+    virtual bool horizontal() const = 0;
+
+    /// Whether the main axis of the container is the horizontal axis, resolved without a virtual call
+    /// for the containers of the library in the closed-world mode.
+    inline bool main_axis_horizontal() const {
+#if defined(VPACKCORE_CLOSED_WORLD)
+        switch (this->node_kind()) {
+            case NodeKind::horizontal:
+                return true;
+            case NodeKind::vertical:
+                return false;
+            default:
+                break;
+        }
+#endif
+        return horizontal();
+    }
+
+    /// Convert from cross-axis point to regular point.
+    ///
     /// \param point A cross-axis based point.
     /// \return A regular point.
-    virtual Point<ValueType> point_from_axis_point(const AxisPoint<ValueType>& point) const = 0;
+    template<typename Scalar>
+    Point<Scalar> point_from_axis_point(const AxisPoint<Scalar>& point) const {
+        return main_axis_horizontal() ? Point<Scalar>(point.main, point.cross) : Point<Scalar>(point.cross, point.main);
+    }
 
     /// Convert from regular point to cross-axis point.
     ///
-    /// This method needs to be implemented by a subclass.
     /// \param point A regular point.
     /// \return A cross-axis based point.
-    virtual AxisPoint<ValueType> axis_point_from_point(const Point<ValueType>& point) const = 0;
+    template<typename Scalar>
+    AxisPoint<Scalar> axis_point_from_point(const Point<Scalar>& point) const {
+        return main_axis_horizontal() ? AxisPoint<Scalar>(point.x, point.y) : AxisPoint<Scalar>(point.y, point.x);
+    }
 
     /// Convert from cross-axis size to regular size.
     ///
-    /// This method needs to be implemented by a subclass.
     /// \param size A cross-axis based size.
     /// \return A regular size.
-    virtual Size<ValueType> size_from_axis_size(const SizeType& size) const = 0;
+    template<typename Scalar>
+    Size<Scalar> size_from_axis_size(const AxisSize<Scalar>& size) const {
+        return main_axis_horizontal() ? Size<Scalar>(size.main, size.cross) : Size<Scalar>(size.cross, size.main);
+    }
 
     /// Convert from regular size to cross-axis size.
     ///
-    /// This method needs to be implemented by a subclass.
     /// \param size A regular size.
     /// \return A cross-axis based size.
-    virtual SizeType axis_size_from_size(const Size<ValueType>& size) const = 0;
+    template<typename Scalar>
+    AxisSize<Scalar> axis_size_from_size(const Size<Scalar>& size) const {
+        return main_axis_horizontal() ? AxisSize<Scalar>(size.width, size.height) : AxisSize<Scalar>(size.height, size.width);
+    }
+
+public:
+    void arrange(const Rect<ValueType>& frame, ArrangeVisitor<Identifier, ValueType>& visitor) const override;
+
+    Size<Affine<ValueType>> measure_affine(const Size<Affine<ValueType>>& size,
+                                           AffinePass<Identifier, ValueType>& pass) override;
 
-    void layout(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const override;
+    void layout_affine(const Rect<Affine<ValueType>>& frame, AffinePass<Identifier, ValueType>& pass) const override;
+
+protected:
+    using usize = std::size_t;
 
-    Size<ValueType> measure(const Size<ValueType>& size) override;
+    /// The indices of the elements of a priority group with their maximum sizes along the main axis.
+    using MainList = ChildArray<std::pair<usize, ValueType>>;
+
+    Size<ValueType> measure_content(const Size<ValueType>& size) override;
+
+    /// The elements of a priority group in the order they are measured,
+    /// i.e. in ascending order of the maximum space they require.
+    MainList measure_order(std::size_t group) const;
+
+private:
+    friend class LayoutProgram<Identifier, ValueType>;
+
+    /// Whether the axis functions of the child elements are known without virtual calls,
+    /// i.e. the container is a horizontal or vertical container of the library in the closed-world mode.
+    inline bool resolves_axes() const {
+#if defined(VPACKCORE_CLOSED_WORLD)
+        return this->node_kind() == NodeKind::horizontal || this->node_kind() == NodeKind::vertical;
+#else
+        return false;
+#endif
+    }
+
+    inline AxisEdgeInsets<ValueType> element_axis_edge_insets(const Element& element) const {
+        if (resolves_axes()) return axis_edge_insets_from_padding(element->padding());
+        return axis_edge_insets_for_element(element);
+    }
+
+    /// The minimum size of the element along the axes of the container.
+    inline AxisSize<ValueType> element_min_size(const Element& element) const {
+        if (resolves_axes()) return axis_size_from_size(Size<ValueType>(element->min_width(), element->min_height()));
+        return { min_main_for_element(element), min_cross_for_element(element) };
+    }
+
+    /// The maximum size of the element along the axes of the container.
+    inline AxisSize<ValueType> element_max_size(const Element& element) const {
+        if (resolves_axes()) return axis_size_from_size(Size<ValueType>(element->max_width(), element->max_height()));
+        return { max_main_for_element(element), max_cross_for_element(element) };
+    }
+
+    /// The maximum number of batches used to predict the measurements of a priority group.
+    static constexpr int max_batch_rounds = 3;
+
+    /// Distributes the space of the container to its elements in descending order of priority.
+    ///
+    /// Shared by the measurement and the affine measurement, `Scalar` is either `ValueType` or `Affine<ValueType>`.
+    ///
+    /// \param size_list The list that receives the sizes of the elements.
+    /// \param measure Measures an element, called with its index in the children list and the proposed size.
+    /// \return The size occupied by the elements.
+    template<typename Scalar, typename MeasureFunction>
+    Size<Scalar> measure_children(const Size<Scalar>& origin_size, SizeList<Scalar> size_list,
+                                  MeasureFunction&& measure);
+
+    /// Distributes the space of a priority group to its elements, in the order of `maximum_main_list`.
+    ///
+    /// \param size_list The list that receives the sizes of the elements.
+    /// \param measure Measures an element, called with its index in the children list and the proposed size.
+    /// \return The size occupied by the group.
+    template<typename Scalar, typename MeasureFunction>
+    AxisSize<Scalar> measure_group(const MainList& maximum_main_list,
+                                   const AxisSize<Scalar>& size, SizeList<Scalar> size_list,
+                                   MeasureFunction&& measure) const;
+
+    /// Measures the batchable elements of a priority group together, with the sizes they are likely proposed.
+    void measure_batchable_children(const MainList& maximum_main_list,
+                                    const SizeType& size, ConstSizeList<ValueType> size_list);
+
+    /// Calculates the frames of the elements with the sizes of the last measurement, shared by `arrange`
+    /// and `layout_affine`.
+    ///
+    /// \param visit Called with each element and its frame in placement order.
+    template<typename Scalar, typename VisitFunction>
+    void arrange_children(const Rect<Scalar>& frame, ConstSizeList<Scalar> size_list,
+                          const Size<Scalar>& measured_size, VisitFunction&& visit) const;
 };
 
 template<typename Identifier, typename ValueType>
-Size<ValueType> HVContainer<Identifier, ValueType>::measure(const Size<ValueType>& origin_size) {
-    const SizeType container_size = axis_size_from_size(origin_size);
+Size<ValueType> HVContainer<Identifier, ValueType>::measure_content(const Size<ValueType>& origin_size) {
+    auto& state = this->measure_state();
+    state.cached_measured_size = measure_children(
+        origin_size, state.size_list,
+        [](usize, const Element& child, const Size<ValueType>& proposed_size) {
+            return child->measure(proposed_size);
+        }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+Size<Affine<ValueType>>
+HVContainer<Identifier, ValueType>::measure_affine(const Size<Affine<ValueType>>& size,
+                                                   AffinePass<Identifier, ValueType>& pass) {
+    auto& state = pass.measure_state(*this);
+    state.size_list.resize(this->children.size());
+    state.cached_measured_size = measure_children(
+        size, state.size_list,
+        [&pass](usize, const Element& child, const Size<Affine<ValueType>>& proposed_size) {
+            return child->measure_affine(proposed_size, pass);
+        }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+template<typename Scalar, typename MeasureFunction>
+Size<Scalar> HVContainer<Identifier, ValueType>::measure_children(const Size<Scalar>& origin_size,
+                                                                  SizeList<Scalar> size_list,
+                                                                  MeasureFunction&& measure) {
+    const AxisSize<Scalar> container_size = axis_size_from_size(origin_size);
     // The total size of the elements in the container that have been calculated.
-    SizeType measured_size;
+    AxisSize<Scalar> measured_size;
 
-    using usize = typename decltype(this->children)::size_type;
-    for (const std::pair<int, std::vector<std::pair<usize, Element>>>& children_pair: this->children_priority_map) {
-        const auto& children = children_pair.second;
+    for (std::size_t group = 0; group < this->priority_group_count(); ++group) {
         // The total container size minus the calculated size is used as
         // the base for calculating the next priority element.
-        const SizeType size = {
-            std::max(static_cast<ValueType>(0), container_size.main - measured_size.main),
+        const AxisSize<Scalar> size = {
+            max<Scalar>(0, container_size.main - measured_size.main),
             container_size.cross
         };
-        std::vector<std::pair<usize, ValueType>> maximum_main_list;
-        maximum_main_list.reserve(children.size());
+        const MainList maximum_main_list = measure_order(group);
+        if constexpr (std::is_same_v<Scalar, ValueType>) {
+            if (this->batchable_children > 1 && maximum_main_list.size() > 1) {
+                measure_batchable_children(maximum_main_list, size, size_list);
+            }
+        }
+        // The size already occupied at the current priority.
+        const AxisSize<Scalar> current_priority_measured_size = measure_group(
+            maximum_main_list, size, size_list, measure
+        );
+        measured_size.main += current_priority_measured_size.main;
+        measured_size.cross = max<Scalar>(current_priority_measured_size.cross, measured_size.cross);
+    }
+
+    return size_from_axis_size(measured_size);
+}
 
-        for (auto it: children) {
-            maximum_main_list.push_back(std::make_pair(it.first, max_main_for_element(it.second)));
+template<typename Identifier, typename ValueType>
+typename HVContainer<Identifier, ValueType>::MainList
+HVContainer<Identifier, ValueType>::measure_order(std::size_t group) const {
+    const std::span<const usize> children = this->priority_group(group);
+    MainList maximum_main_list;
+    maximum_main_list.reserve(children.size());
+
+    for (const usize index: children) {
+        maximum_main_list.push_back(std::make_pair(index, element_max_size(this->children[index]).main));
+    }
+
+    // Sort the elements in ascending order by the maximum space required.
+    std::sort(
+        maximum_main_list.begin(), maximum_main_list.end(),
+        [](const auto& a, const auto& b) {
+            return a.second < b.second;
         }
+    );
+    return maximum_main_list;
+}
+
+template<typename Identifier, typename ValueType>
+template<typename Scalar, typename MeasureFunction>
+AxisSize<Scalar>
+HVContainer<Identifier, ValueType>::measure_group(const MainList& maximum_main_list,
+                                                  const AxisSize<Scalar>& size, SizeList<Scalar> size_list,
+                                                  MeasureFunction&& measure) const {
+    // The size already occupied at the current priority.
+    AxisSize<Scalar> current_priority_measured_size;
+    const usize list_count = maximum_main_list.size();
+    for (auto it: makeIndexed(maximum_main_list)) {
+        const usize index = it.index();
+
+        const Scalar rest_main = size.main - current_priority_measured_size.main;
+        /// The number of remaining elements that need to be allocated additional space.
+        const usize count = list_count - index;
+        // The remaining elements share the remaining space equally,
+        // i.e., the space occupied by each element is not allowed to exceed this value.
+        const Scalar maximum_container_main = rest_main / static_cast<ValueType>(count);
+        /// The position of the element instance in the children list.
+        const usize element_idx = it.value().first;
+        const auto& child = this->children[element_idx];
+        const AxisEdgeInsets<ValueType> padding = element_axis_edge_insets(child);
+        const AxisSize<ValueType> min_size = element_min_size(child);
+        const AxisSize<ValueType> max_size = element_max_size(child);
+        // Make the element size with the maximum space of available containers.
+        const AxisSize<Scalar> item_size = axis_size_from_size(measure(element_idx, child, size_from_axis_size(
+            AxisSize<Scalar>{
+                min<Scalar>(maximum_container_main - padding.main(), max_size.main),
+                min<Scalar>(size.cross - padding.cross(), max_size.cross)
+            }
+        )));
+
+        // Size limit on the calculation result.
+        const Scalar main = max<Scalar>(min_size.main,
+                                        min<Scalar>(item_size.main, maximum_container_main - padding.main()));
+        const Scalar cross = max<Scalar>(min_size.cross,
+                                         min<Scalar>(item_size.cross, size.cross - padding.cross()));
+        // The size of the element after subtracting padding is the actual size of the element.
+        size_list[element_idx] = size_from_axis_size(AxisSize<Scalar>{ main, cross });
+        // The padding needs to be taken into account when counting the actual size of the occupancy.
+        current_priority_measured_size.main += (main + padding.main());
+        current_priority_measured_size.cross = max<Scalar>(current_priority_measured_size.cross,
+                                                           cross + padding.cross());
+    }
+    return current_priority_measured_size;
+}
 
-        // Sort the elements in ascending order by the maximum space required.
-        std::sort(
-            maximum_main_list.begin(), maximum_main_list.end(),
-            [](const auto& a, const auto& b) {
-                return a.second < b.second;
+template<typename Identifier, typename ValueType>
+void HVContainer<Identifier, ValueType>::measure_batchable_children(
+    const MainList& maximum_main_list, const SizeType& size,
+    ConstSizeList<ValueType> size_list
+) {
+    // The sizes proposed to the elements of a group depend on the sizes of the elements measured before them.
+    // Predict the proposed sizes by running the distribution with guessed sizes, starting from the sizes of
+    // the last measurement, and measure the batchable elements with the predicted sizes. The guesses of the
+    // batched elements are exact in the next round, so the predictions usually converge within a few rounds.
+    // Wrong predictions only cost time, the measurement that follows measures them again.
+    ChildArray<Size<ValueType>> guessed_sizes(size_list.begin(), size_list.end());
+    for (int round = 0; round < max_batch_rounds; ++round) {
+        LeafBatch<Identifier, ValueType> batch;
+        measure_group(
+            maximum_main_list, size, guessed_sizes,
+            [&](usize element_idx, const Element& child, const Size<ValueType>& proposed_size) {
+                if (const auto cached_size = child->cached_measurement(proposed_size)) return *cached_size;
+                batch.add(*child, proposed_size);
+                return guessed_sizes[element_idx];
             }
         );
-        // The size already occupied at the current priority.
-        SizeType current_priority_measured_size;
-        const usize list_count = maximum_main_list.size();
-        for (auto it: makeIndexed(maximum_main_list)) {
-            const usize index = it.index();
-
-            const ValueType rest_main = size.main - current_priority_measured_size.main;
-            /// The number of remaining elements that need to be allocated additional space.
-            const usize count = list_count - index;
-            // The remaining elements share the remaining space equally,
-            // i.e., the space occupied by each element is not allowed to exceed this value.
-            const ValueType maximum_container_main = rest_main / count;
-            /// The position of the element instance in the children list.
-            const usize element_idx = it.value().first;
-            const auto child = this->children[element_idx];
-            const AxisEdgeInsets<ValueType> padding = axis_edge_insets_for_element(child);
-            // Make the element size with the maximum space of available containers.
-            const SizeType item_size = axis_size_from_size(child->measure(size_from_axis_size(
-                {
-                    std::min(maximum_container_main - padding.main(),
-                             max_main_for_element(child)),
-                    std::min(size.cross - padding.cross(),
-                             max_cross_for_element(child))
-                }
-            )));
-
-            // Size limit on the calculation result.
-            const ValueType main = std::max(min_main_for_element(child),
-                                            std::min(item_size.main, maximum_container_main - padding.main()));
-            const ValueType cross = std::max(min_cross_for_element(child),
-                                             std::min(item_size.cross, size.cross - padding.cross()));
-            // The size of the element after subtracting padding is the actual size of the element.
-            this->size_list.at(element_idx) = size_from_axis_size({ main, cross });
-            // The padding needs to be taken into account when counting the actual size of the occupancy.
-            current_priority_measured_size.main += (main + padding.main());
-            current_priority_measured_size.cross = std::max(current_priority_measured_size.cross,
-                                                            cross + padding.cross());
-        }
-        measured_size.main += current_priority_measured_size.main;
-        measured_size.cross = std::max(current_priority_measured_size.cross, measured_size.cross);
+        if (batch.empty()) return;
+        batch.run();
     }
+}
 
-    this->cached_measured_size = size_from_axis_size(measured_size);
-    return this->cached_measured_size;
+template<typename Identifier, typename ValueType>
+void HVContainer<Identifier, ValueType>::arrange(const Rect<ValueType>& frame,
+                                                 ArrangeVisitor<Identifier, ValueType>& visitor) const {
+    const auto& state = this->measure_state();
+    arrange_children(
+        frame, state.size_list, state.cached_measured_size,
+        [&visitor](const Element& child, const Rect<ValueType>& child_frame) {
+            visitor.visit(*child, child_frame, false);
+        }
+    );
+}
+
+template<typename Identifier, typename ValueType>
+void HVContainer<Identifier, ValueType>::layout_affine(const Rect<Affine<ValueType>>& frame,
+                                                       AffinePass<Identifier, ValueType>& pass) const {
+    const auto& state = pass.measure_state(*this);
+    arrange_children(
+        frame, state.size_list, state.cached_measured_size,
+        [&pass](const Element& child, const Rect<Affine<ValueType>>& child_frame) {
+            child->layout_affine(child_frame, pass);
+        }
+    );
 }
 
 template<typename Identifier, typename ValueType>
-void HVContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
-                                                LayoutResult<Identifier, ValueType>& result) const {
+template<typename Scalar, typename VisitFunction>
+void HVContainer<Identifier, ValueType>::arrange_children(const Rect<Scalar>& frame,
+                                                          ConstSizeList<Scalar> size_list,
+                                                          const Size<Scalar>& measured_size,
+                                                          VisitFunction&& visit) const {
     // Layout in terms of the actual space occupied by the elements.
-    const AxisPoint<ValueType> origin = axis_point_from_point(
-        {
+    const AxisPoint<Scalar> origin = axis_point_from_point(
+        Point<Scalar>{
             frame.x +
-            (frame.width - this->cached_measured_size.width) / 2,
+            (frame.width - measured_size.width) / 2,
             frame.y +
-            (frame.height - this->cached_measured_size.height) / 2
+            (frame.height - measured_size.height) / 2
         }
     );
-    const AxisSize<ValueType> size = axis_size_from_size(
-        {
-            std::max(frame.width, this->cached_measured_size.width),
-            std::max(frame.height, this->cached_measured_size.height)
+    const AxisSize<Scalar> size = axis_size_from_size(
+        Size<Scalar>{
+            max<Scalar>(frame.width, measured_size.width),
+            max<Scalar>(frame.height, measured_size.height)
         }
     );
 
-    ValueType used_main = 0;
+    const AxisAlignment alignment = this->axis_alignment();
+    Scalar used_main = 0;
     for (auto it: makeIndexed(this->children)) {
         const auto child_ptr = it.value();
 
-        const auto item_size = axis_size_from_size(this->size_list[it.index()]);
-        const auto item_padding = axis_edge_insets_for_element(child_ptr);
+        const auto item_size = axis_size_from_size(size_list[it.index()]);
+        const auto item_padding = element_axis_edge_insets(child_ptr);
         /// The total size of the accommodating elements.
         ///
         /// The actual size of the element plus the element's own padding.
-        const SizeType item_container_size = {
+        const AxisSize<Scalar> item_container_size = {
             item_size.main + item_padding.main(),
             item_size.cross + item_padding.cross()
         };
         // The container allows to specify its alignment on the cross axis,
         // so there will be an offset on the cross axis.
-        const auto cross_offset = [this, &size, &item_container_size]() -> ValueType {
-            switch (this->axis_alignment()) {
+        const auto cross_offset = [alignment, &size, &item_container_size]() -> Scalar {
+            switch (alignment) {
                 case AxisAlignment::start:
                     return 0;
                 case AxisAlignment::center:
@@ -240,16 +464,17 @@ void HVContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
                 case AxisAlignment::end:
                     return size.cross - item_container_size.cross;
             }
+            return 0;
         }();
         const auto item_offset = axis_point_from_point(child_ptr->offset());
-        const auto layout_frame_for_child = Rect<ValueType>(
+        const auto layout_frame_for_child = Rect<Scalar>(
             point_from_axis_point(
-                { origin.main + used_main + item_offset.main + item_padding.main_start,
-                  origin.cross + cross_offset + item_offset.cross + item_padding.cross_start }
+                AxisPoint<Scalar>{ origin.main + used_main + item_offset.main + item_padding.main_start,
+                                   origin.cross + cross_offset + item_offset.cross + item_padding.cross_start }
             ),
             size_from_axis_size(item_size)
         );
-        child_ptr->layout(layout_frame_for_child, result);
+        visit(child_ptr, layout_frame_for_child);
         used_main += item_container_size.main;
     }
 }
@@ -0,0 +1,90 @@
+//
+// Created by ktiays on 2022/9/13.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_LEAF_BATCH_HPP
+#define VPACKCORE_LEAF_BATCH_HPP
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "../layoutable.hpp"
+#include "../batch_measurable.hpp"
+#include "../../measure_cache.hpp"
+
+namespace vpk::core::detail {
+
+/// Collects the measurements of child elements that can be batched, see `BatchMeasurable`.
+///
+/// Running the batch stores the measured sizes in the measurement caches of the elements,
+/// so the following calls of `measure` with the same proposed sizes are answered from the caches.
+template<typename Identifier, typename ValueType>
+class LeafBatch {
+public:
+    inline bool empty() const { return elements_.empty(); }
+
+    /// Adds the measurement of the element if it can be batched and has not been cached.
+    void add(Layoutable<Identifier, ValueType>& element, const Size<ValueType>& proposed_size) {
+        const BatchMeasurable<ValueType>* measurable = element.batch_measurable();
+        if (!measurable || element.cached_measurement(proposed_size).has_value()) return;
+        // Content that has been measured anywhere else needs no place in the batch.
+        if (const auto content_key = measurable->content_key()) {
+            if (const auto size = SharedMeasureCache<ValueType>::global().find(*content_key, proposed_size)) {
+                element.store_measurement(proposed_size, *size);
+                return;
+            }
+        }
+        elements_.push_back(&element);
+        requests_.push_back({ measurable, proposed_size, {}});
+    }
+
+    /// Passes the collected measurements to their measurers, one batch per measurer.
+    void run();
+
+private:
+    std::vector<Layoutable<Identifier, ValueType>*> elements_;
+    std::vector<BatchMeasureRequest<ValueType>> requests_;
+};
+
+template<typename Identifier, typename ValueType>
+void LeafBatch<Identifier, ValueType>::run() {
+    LayoutContext* context = LayoutContext::current();
+    if (elements_.empty() || (context && context->interrupted())) return;
+
+    // Group the requests of each measurer, keeping the order of the children within a group.
+    std::vector<std::size_t> order(requests_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return std::less<>{}(requests_[a].measurable->batch_measurer(), requests_[b].measurable->batch_measurer());
+    });
+    std::vector<BatchMeasureRequest<ValueType>> requests;
+    requests.reserve(order.size());
+    for (const std::size_t index: order) {
+        requests.push_back(requests_[index]);
+    }
+
+    for (std::size_t begin = 0; begin < requests.size();) {
+        const BatchMeasurer<ValueType>* measurer = requests[begin].measurable->batch_measurer();
+        std::size_t end = begin + 1;
+        while (end < requests.size() && requests[end].measurable->batch_measurer() == measurer) ++end;
+        measurer->measure_batch(std::span(requests).subspan(begin, end - begin));
+        begin = end;
+    }
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const BatchMeasureRequest<ValueType>& request = requests[i];
+        elements_[order[i]]->store_measurement(request.proposed_size, request.measured_size);
+        if (const auto content_key = request.measurable->content_key()) {
+            SharedMeasureCache<ValueType>::global().insert(*content_key, request.proposed_size, request.measured_size);
+        }
+    }
+    if (context) context->stats().batched_nodes += requests.size();
+    elements_.clear();
+    requests_.clear();
+}
+
+}
+
+#endif //VPACKCORE_LEAF_BATCH_HPP
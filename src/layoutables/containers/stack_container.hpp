@@ -17,35 +17,94 @@ namespace vpk::core {
 template<typename Identifier, typename ValueType>
 class StackContainer : public Container<Identifier, ValueType> {
 public:
-    StackContainer(const std::vector<LayoutablePointer<Identifier, ValueType>>& children,
+    StackContainer(std::vector<LayoutablePointer<Identifier, ValueType>> children,
                    const LayoutParams<ValueType>& params, Alignment align)
-        : Container<Identifier, ValueType>(children, params), alignment(align) {
-        const SizeProperty<ValueType> size_property = params.size_property;
-        __DEAL_MIN_WIDTH_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MAX_WIDTH_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MIN_HEIGHT_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MAX_HEIGHT_FOR_POLICY(MinMaxPolicy::max);
+        : Container<Identifier, ValueType>(std::move(children), params, MinMaxPolicy::max, MinMaxPolicy::max),
+          alignment(align) {
+        // Every child is lifted above the previous ones when it is placed.
+        this->subtree_lifts_ += this->children.size();
     }
 
-    void layout(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const override;
+    StackContainer(std::span<const LayoutablePointer<Identifier, ValueType>> children,
+                   const LayoutParams<ValueType>& params, Alignment align)
+        : StackContainer(std::vector(children.begin(), children.end()), params, align) {}
+
+    void arrange(const Rect<ValueType>& frame, ArrangeVisitor<Identifier, ValueType>& visitor) const override;
+
+    Size<Affine<ValueType>> measure_affine(const Size<Affine<ValueType>>& size,
+                                           detail::AffinePass<Identifier, ValueType>& pass) override;
 
-    Size<ValueType> measure(const Size<ValueType>& size) override;
+    void layout_affine(const Rect<Affine<ValueType>>& frame,
+                       detail::AffinePass<Identifier, ValueType>& pass) const override;
+
+protected:
+    Size<ValueType> measure_content(const Size<ValueType>& size) override;
+
+    detail::NodeKind exact_node_kind() const override { return detail::kind_if_exact(*this, detail::NodeKind::stack); }
 
 private:
+    friend class LayoutProgram<Identifier, ValueType>;
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
     Alignment alignment;
+
+    /// Measures the elements, shared by the measurement and the affine measurement.
+    ///
+    /// \param size_list The list that receives the sizes of the elements.
+    /// \param measure Measures an element, called with the element and the proposed size.
+    /// \return The size occupied by the elements.
+    template<typename Scalar, typename MeasureFunction>
+    Size<Scalar> measure_children(const Size<Scalar>& size, detail::SizeList<Scalar> size_list,
+                                  MeasureFunction&& measure);
+
+    /// Calculates the frames of the elements with the sizes of the last measurement, shared by `arrange`
+    /// and `layout_affine`.
+    ///
+    /// \param visit Called with each element and its frame in placement order.
+    template<typename Scalar, typename VisitFunction>
+    void arrange_children(const Rect<Scalar>& frame, detail::ConstSizeList<Scalar> size_list,
+                          const Size<Scalar>& measured_size, VisitFunction&& visit) const;
 };
 
 template<typename Identifier, typename ValueType>
-void StackContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
-                                                   LayoutResult<Identifier, ValueType>& result) const {
+void StackContainer<Identifier, ValueType>::arrange(const Rect<ValueType>& frame,
+                                                    ArrangeVisitor<Identifier, ValueType>& visitor) const {
+    const auto& state = this->measure_state();
+    arrange_children(
+        frame, state.size_list, state.cached_measured_size,
+        [&visitor](const auto& child, const Rect<ValueType>& child_frame) {
+            // Lift z-index of the child.
+            visitor.visit(*child, child_frame, true);
+        }
+    );
+}
+
+template<typename Identifier, typename ValueType>
+void StackContainer<Identifier, ValueType>::layout_affine(const Rect<Affine<ValueType>>& frame,
+                                                          detail::AffinePass<Identifier, ValueType>& pass) const {
+    const auto& state = pass.measure_state(*this);
+    arrange_children(
+        frame, state.size_list, state.cached_measured_size,
+        [&pass](const auto& child, const Rect<Affine<ValueType>>& child_frame) {
+            child->layout_affine(child_frame, pass);
+        }
+    );
+}
+
+template<typename Identifier, typename ValueType>
+template<typename Scalar, typename VisitFunction>
+void StackContainer<Identifier, ValueType>::arrange_children(const Rect<Scalar>& frame,
+                                                             detail::ConstSizeList<Scalar> size_list,
+                                                             const Size<Scalar>& measured_size,
+                                                             VisitFunction&& visit) const {
     // Layout in terms of the actual space occupied by the elements.
-    const Point<ValueType> origin = {
-        frame.x + (frame.width - this->cached_measured_size.width) / 2,
-        frame.y + (frame.height - this->cached_measured_size.height) / 2
+    const Point<Scalar> origin = {
+        frame.x + (frame.width - measured_size.width) / 2,
+        frame.y + (frame.height - measured_size.height) / 2
     };
-    const Size<ValueType> size = {
-        std::max(frame.width, this->cached_measured_size.width),
-        std::max(frame.height, this->cached_measured_size.height)
+    const Size<Scalar> size = {
+        detail::max<Scalar>(frame.width, measured_size.width),
+        detail::max<Scalar>(frame.height, measured_size.height)
     };
 
     for (const auto it: makeIndexed(this->children)) {
@@ -53,12 +112,12 @@ void StackContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
         const auto child = it.value();
         const EdgeInsets<ValueType> padding = child->padding();
 
-        const Size<ValueType> item_size = this->size_list.at(index);
-        const Size<ValueType> item_container_size = {
+        const Size<Scalar> item_size = size_list[index];
+        const Size<Scalar> item_container_size = {
             item_size.width + padding.horizontal(),
             item_size.height + padding.vertical()
         };
-        const ValueType x_offset = [this, &size, &item_container_size]() -> ValueType {
+        const Scalar x_offset = [this, &size, &item_container_size]() -> Scalar {
             switch (this->alignment.horizontal()) {
                 case HorizontalAlignment::leading:
                     return 0;
@@ -67,8 +126,9 @@ void StackContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
                 case HorizontalAlignment::trailing:
                     return size.width - item_container_size.width;
             }
+            return 0;
         }();
-        const ValueType y_offset = [this, &size, &item_container_size]() -> ValueType {
+        const Scalar y_offset = [this, &size, &item_container_size]() -> Scalar {
             switch (this->alignment.vertical()) {
                 case VerticalAlignment::top:
                     return 0;
@@ -77,42 +137,79 @@ void StackContainer<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
                 case VerticalAlignment::bottom:
                     return size.height - item_container_size.height;
             }
+            return 0;
         }();
         const Point<ValueType> item_offset = child->offset();
-        const Rect<ValueType> layout_frame = Rect<ValueType>{
+        const Rect<Scalar> layout_frame = Rect<Scalar>{
             origin.x + x_offset + padding.left + item_offset.x,
             origin.y + y_offset + padding.top + item_offset.y,
             item_size.width,
             item_size.height,
         };
 
-        // Lift z-index of the child.
-        result.max_z_idx += 1;
-        child->layout(layout_frame, result);
+        visit(child, layout_frame);
     }
 }
 
 template<typename Identifier, typename ValueType>
-Size<ValueType> StackContainer<Identifier, ValueType>::measure(const Size<ValueType>& size) {
-    Size<ValueType> measured_size;
+Size<ValueType> StackContainer<Identifier, ValueType>::measure_content(const Size<ValueType>& size) {
+    auto& state = this->measure_state();
+    state.cached_measured_size = measure_children(
+        size, state.size_list,
+        [](const auto& child, const Size<ValueType>& proposed_size) { return child->measure(proposed_size); }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+Size<Affine<ValueType>>
+StackContainer<Identifier, ValueType>::measure_affine(const Size<Affine<ValueType>>& size,
+                                                      detail::AffinePass<Identifier, ValueType>& pass) {
+    auto& state = pass.measure_state(*this);
+    state.size_list.resize(this->children.size());
+    state.cached_measured_size = measure_children(
+        size, state.size_list,
+        [&pass](const auto& child, const Size<Affine<ValueType>>& proposed_size) {
+            return child->measure_affine(proposed_size, pass);
+        }
+    );
+    return state.cached_measured_size;
+}
+
+template<typename Identifier, typename ValueType>
+template<typename Scalar, typename MeasureFunction>
+Size<Scalar> StackContainer<Identifier, ValueType>::measure_children(const Size<Scalar>& size,
+                                                                     detail::SizeList<Scalar> size_list,
+                                                                     MeasureFunction&& measure) {
+    Size<Scalar> measured_size;
+    const auto proposed_size = [&size](const auto& child) {
+        const EdgeInsets<ValueType> padding = child->padding();
+        return child->preferred_size(Size<Scalar>{ size.width - padding.horizontal(), size.height - padding.vertical() });
+    };
     // The element sizes in `StackContainer` are not affected by each other.
-    // Therefore, priority map is not used here.
+    // Therefore, priority map is not used here, and the batchable children can be measured together beforehand.
+    if constexpr (std::is_same_v<Scalar, ValueType>) {
+        if (this->batchable_children > 1) {
+            detail::LeafBatch<Identifier, ValueType> batch;
+            for (const auto& child: this->children) {
+                batch.add(*child, proposed_size(child));
+            }
+            batch.run();
+        }
+    }
     for (auto it: makeIndexed(this->children)) {
         const auto child = it.value();
 
         const EdgeInsets<ValueType> padding = child->padding();
 
-        Size<ValueType> item_size = child->preferred_size(child->measure(child->preferred_size(
-            { size.width - padding.horizontal(), size.height - padding.vertical() }
-        )));
-        this->size_list.at(it.index()) = item_size;
-        measured_size = Size<ValueType>{
-            std::max(item_size.width + padding.horizontal(), measured_size.width),
-            std::max(item_size.height + padding.vertical(), measured_size.height)
+        Size<Scalar> item_size = child->preferred_size(measure(child, proposed_size(child)));
+        size_list[it.index()] = item_size;
+        measured_size = Size<Scalar>{
+            detail::max<Scalar>(item_size.width + padding.horizontal(), measured_size.width),
+            detail::max<Scalar>(item_size.height + padding.vertical(), measured_size.height)
         };
     }
 
-    this->cached_measured_size = measured_size;
     return measured_size;
 }
 
@@ -16,21 +16,19 @@ namespace vpk::core {
 template<typename Identifier, typename ValueType>
 class VerticalContainer : public detail::HVContainer<Identifier, ValueType> {
 public:
-    VerticalContainer(const std::vector<LayoutablePointer<Identifier, ValueType>>& children,
+    VerticalContainer(std::vector<LayoutablePointer<Identifier, ValueType>> children,
                       const LayoutParams<ValueType>& params, HorizontalAlignment align)
-        : detail::HVContainer<Identifier, ValueType>(children, params), alignment(align) {
-        const SizeProperty<ValueType> size_property = params.size_property;
-        __DEAL_MIN_WIDTH_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MAX_WIDTH_FOR_POLICY(MinMaxPolicy::max);
-        __DEAL_MIN_HEIGHT_FOR_POLICY(MinMaxPolicy::sum);
-        __DEAL_MAX_HEIGHT_FOR_POLICY(MinMaxPolicy::sum);
-    }
+        : detail::HVContainer<Identifier, ValueType>(std::move(children), params, MinMaxPolicy::max, MinMaxPolicy::sum),
+          alignment(align) {}
+
+    VerticalContainer(std::span<const LayoutablePointer<Identifier, ValueType>> children,
+                      const LayoutParams<ValueType>& params, HorizontalAlignment align)
+        : VerticalContainer(std::vector(children.begin(), children.end()), params, align) {}
 
     using Element = typename detail::HVContainer<Identifier, ValueType>::Element;
 
     detail::AxisEdgeInsets<ValueType> axis_edge_insets_for_element(Element element) const override {
-        const EdgeInsets<ValueType> padding = element->padding();
-        return { padding.left, padding.right, padding.top, padding.bottom };
+        return detail::axis_edge_insets_from_padding(element->padding());
     }
 
     ValueType min_main_for_element(Element element) const override { return element->min_height(); }
@@ -41,21 +39,7 @@ public:
 
     ValueType max_cross_for_element(Element element) const override { return element->max_width(); }
 
-    Point<ValueType> point_from_axis_point(const detail::AxisPoint<ValueType>& point) const override {
-        return { point.cross, point.main };
-    }
-
-    detail::AxisPoint<ValueType> axis_point_from_point(const Point<ValueType>& point) const override {
-        return { point.y, point.x };
-    }
-
-    Size<ValueType> size_from_axis_size(const detail::AxisSize<ValueType>& size) const override {
-        return { size.cross, size.main };
-    };
-
-    detail::AxisSize<ValueType> axis_size_from_size(const Size<ValueType>& size) const override {
-        return { size.height, size.width };
-    };
+    bool horizontal() const override { return false; }
 
     detail::AxisAlignment axis_alignment() const override {
         switch (alignment) {
@@ -66,9 +50,17 @@ public:
             case HorizontalAlignment::trailing:
                 return detail::AxisAlignment::end;
         }
+        return detail::AxisAlignment::start;
+    }
+
+protected:
+    detail::NodeKind exact_node_kind() const override {
+        return detail::kind_if_exact(*this, detail::NodeKind::vertical);
     }
 
 private:
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
     HorizontalAlignment alignment;
 
 };
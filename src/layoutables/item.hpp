@@ -6,10 +6,15 @@
 #ifndef VPACKCORE_ITEM_HPP
 #define VPACKCORE_ITEM_HPP
 
+#include <array>
+#include <memory>
 #include <cassert>
 
 #include "layoutable.hpp"
 #include "measurable.hpp"
+#include "batch_measurable.hpp"
+#include "../optional.hpp"
+#include "../measure_cache.hpp"
 
 namespace vpk::core {
 
@@ -17,7 +22,18 @@ template<typename Identifier, typename ValueType>
 class Item : public Layoutable<Identifier, ValueType> {
 public:
     Item(Identifier id, LayoutParams<ValueType> p, std::shared_ptr<Measurable<ValueType>> m)
-        : Layoutable<Identifier, ValueType>(p), identifier_(id), measurable(m) {
+        : Item(p, m) {
+        identifier_ = std::move(id);
+    }
+
+    /// Creates an anonymous item.
+    ///
+    /// An anonymous item takes part in the layout like any other item, e.g. a spacer,
+    /// but its frame is never written to the layout result.
+    Item(LayoutParams<ValueType> p, std::shared_ptr<Measurable<ValueType>> m)
+        : Layoutable<Identifier, ValueType>(p), measurable(m),
+          async_measurable(dynamic_cast<const AsyncMeasurable<ValueType>*>(m.get())),
+          batch_measurable_(dynamic_cast<const BatchMeasurable<ValueType>*>(m.get())) {
         const SizeProperty<ValueType> size_property = p.size_property;
         assert(
             size_property.min_width.has_value()
@@ -25,34 +41,141 @@ public:
             && size_property.max_width.has_value()
             && size_property.max_height.has_value()
         );
-        this->min_width_ = *size_property.min_width;
-        this->min_height_ = *size_property.min_height;
-        this->max_width_ = *size_property.max_width;
-        this->max_height_ = *size_property.max_height;
     }
 
-    inline Identifier identifier() const { return identifier_; }
+    inline bool anonymous() const { return !identifier_.has_value(); }
+
+    inline const Identifier& identifier() const {
+        assert(!anonymous());
+        return *identifier_;
+    }
+
+    void emit(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const override;
+
+    Size<Affine<ValueType>> measure_affine(const Size<Affine<ValueType>>& size,
+                                           detail::AffinePass<Identifier, ValueType>& pass) override;
+
+    void layout_affine(const Rect<Affine<ValueType>>& frame,
+                       detail::AffinePass<Identifier, ValueType>& pass) const override {
+        if (!anonymous()) pass.emit(identifier(), frame);
+    }
+
+    const BatchMeasurable<ValueType>* batch_measurable() const override { return batch_measurable_; }
 
-    void layout(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const override;
+protected:
+    Size<ValueType> measure_content(const Size<ValueType>& size) override;
+
+    void discard_measurements() override {
+        measurements.for_each([](BufferMeasurement& buffer) { buffer.measurement.reset(); });
+        pending_measurements.reset();
+    }
 
-    Size<ValueType> measure(const Size<ValueType>& size) override;
+    detail::NodeKind exact_node_kind() const override { return detail::kind_if_exact(*this, detail::NodeKind::item); }
 
 private:
-    Identifier identifier_;
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
+    struct PendingMeasurement {
+        Size<ValueType> proposed_size;
+        /// The measure pass that started the measurement.
+        uint64_t pass;
+        Task<Size<ValueType>> task;
+    };
+
+    struct BufferMeasurement {
+        optional<Measurement<ValueType>> measurement;
+        /// The measure pass of the measurement, see `current_measurement`.
+        uint64_t pass = 0;
+    };
+
     std::shared_ptr<Measurable<ValueType>> measurable;
+    /// The measurable if it can be measured asynchronously.
+    const AsyncMeasurable<ValueType>* async_measurable;
+    const BatchMeasurable<ValueType>* batch_measurable_;
+    /// The last measurement of the measurable in each measurement buffer, with the sizes it holds for.
+    detail::MeasureBuffers<BufferMeasurement> measurements;
+    /// The deferred measurement of each measurement buffer, only allocated for asynchronous measurables.
+    std::unique_ptr<std::array<optional<PendingMeasurement>, measure_buffer_count>> pending_measurements;
+    /// Only read by the placement, it follows the measurement data.
+    optional<Identifier> identifier_;
+
+    /// The measurement of the current measurement buffer, discarded if it belongs to another measure pass.
+    optional<Measurement<ValueType>>& current_measurement() {
+        BufferMeasurement& buffer = measurements[detail::current_measure_buffer()];
+        const uint64_t pass = detail::current_measure_pass();
+        if (pass == 0 || buffer.pass != pass) {
+            buffer.measurement.reset();
+            buffer.pass = pass;
+        }
+        return buffer.measurement;
+    }
 };
 
 template<typename Identifier, typename ValueType>
-void Item<Identifier, ValueType>::layout(const Rect<ValueType>& frame,
-                                         LayoutResult<Identifier, ValueType>& result) const {
-    const auto iter = result.map.find(identifier());
-    assert(iter == result.map.end());
-    result.map[identifier()] = { .frame = frame, .z_idx = result.max_z_idx };
+void Item<Identifier, ValueType>::emit(const Rect<ValueType>& frame,
+                                       LayoutResult<Identifier, ValueType>& result) const {
+    if (anonymous()) return;
+    [[maybe_unused]] const auto inserted = result.map.insert_or_assign(
+        identifier(), LayoutAttributes<ValueType>{ .frame = frame, .z_idx = result.max_z_idx }
+    ).second;
+    // Every identifier may only appear once in the layout tree.
+    assert(inserted);
 }
 
 template<typename Identifier, typename ValueType>
-Size<ValueType> Item<Identifier, ValueType>::measure(const Size<ValueType>& size) {
-    return measurable->measure(size);
+Size<Affine<ValueType>> Item<Identifier, ValueType>::measure_affine(const Size<Affine<ValueType>>& size,
+                                                                    detail::AffinePass<Identifier, ValueType>&) {
+    if (measurable->measures_proposed_size()) return size;
+    // The size of the measurable is constant as long as the proposed size stays within the sizes
+    // the measurement holds for.
+    const Size<ValueType> proposed_size = { size.width.value, size.height.value };
+    optional<Measurement<ValueType>>& measurement = current_measurement();
+    if (!measurement.has_value() || !measurement->holds_for(proposed_size)) {
+        measurement = measurable->measure_with_validity(proposed_size);
+    }
+    detail::require_in_range(size.width, measurement->width_range);
+    detail::require_in_range(size.height, measurement->height_range);
+    return { measurement->size.width, measurement->size.height };
+}
+
+template<typename Identifier, typename ValueType>
+Size<ValueType> Item<Identifier, ValueType>::measure_content(const Size<ValueType>& size) {
+    // The measurement of the last proposed size may hold for this one as well, e.g. for a text
+    // that breaks into the same lines.
+    optional<Measurement<ValueType>>& measurement = current_measurement();
+    if (measurement.has_value() && measurement->holds_for(size)) return measurement->size;
+
+    const optional<std::size_t> content_key = measurable->content_key();
+    if (content_key.has_value()) {
+        if (const auto cached_size = SharedMeasureCache<ValueType>::global().find(*content_key, size)) {
+            return *cached_size;
+        }
+    }
+    const auto cache = [&content_key, &size](const Size<ValueType>& measured_size) {
+        if (content_key.has_value()) SharedMeasureCache<ValueType>::global().insert(*content_key, size, measured_size);
+        return measured_size;
+    };
+
+    LayoutContext* context = LayoutContext::current();
+    if (!async_measurable || !context || !context->defers_measurements()) {
+        measurement = measurable->measure_with_validity(size);
+        return cache(measurement->size);
+    }
+
+    if (!pending_measurements) {
+        pending_measurements = std::make_unique<std::array<optional<PendingMeasurement>, measure_buffer_count>>();
+    }
+    optional<PendingMeasurement>& pending = (*pending_measurements)[context->measure_buffer()];
+    if (!pending.has_value() || pending->proposed_size != size || pending->pass != context->measure_pass()) {
+        pending = PendingMeasurement{ size, context->measure_pass(), async_measurable->measure_async(size) };
+    }
+    if (pending->task.ready()) {
+        const Size<ValueType> measured_size = pending->task.get();
+        pending.reset();
+        return cache(measured_size);
+    }
+    context->defer_measurement(pending->task.handle());
+    return {};
 }
 
 }
@@ -6,24 +6,52 @@
 #ifndef VPACKCORE_LAYOUTABLE_HPP
 #define VPACKCORE_LAYOUTABLE_HPP
 
+#include <span>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "../affine.hpp"
 #include "../layout_result.hpp"
+#include "../compact_optional.hpp"
+#include "../intrusive_pointer.hpp"
+#include "../layout_context.hpp"
 #include "../types.hpp"
 
 namespace vpk::core {
 
+/// The size limits specified for an element, unspecified limits are calculated by the element itself.
+///
+/// The limits are compact optionals, a size property takes no more space than four values.
 template<typename ValueType>
 struct SizeProperty {
-    optional<ValueType> min_width;
-    optional<ValueType> min_height;
-    optional<ValueType> max_width;
-    optional<ValueType> max_height;
+    CompactOptional<ValueType> min_width;
+    CompactOptional<ValueType> min_height;
+    CompactOptional<ValueType> max_width;
+    CompactOptional<ValueType> max_height;
 };
 
+/// The minimum and maximum sizes of an element, excluding its padding.
+template<typename ValueType>
+struct IntrinsicSize {
+    Size<ValueType> min;
+    Size<ValueType> max;
+};
+
+/// The parameters of an element.
+///
+/// The padding is read by every measurement of the parent, the other parameters only by the construction
+/// of the element and its placement. The padding comes first, so it sits next to the measurement data
+/// of the element (see `Layoutable`).
 template<typename ValueType>
 struct LayoutParams {
-    SizeProperty<ValueType> size_property;
     EdgeInsets<ValueType> padding;
     Point<ValueType> offset;
+    SizeProperty<ValueType> size_property;
 
     /// The layout priority of the element.
     ///
@@ -35,65 +63,550 @@ struct LayoutParams {
 
     LayoutParams(const SizeProperty<ValueType>& size, const EdgeInsets<ValueType>& insets,
                  const Point<ValueType>& offset, int priority = 0)
-        : size_property(size), padding(insets), offset(offset), priority(priority) {}
+        : padding(insets), offset(offset), size_property(size), priority(priority) {}
 
     LayoutParams(SizeProperty<ValueType>&& size, EdgeInsets<ValueType>&& insets,
                  Point<ValueType>&& offset, int priority = 0)
-        : size_property(std::move(size)), padding(std::move(insets)), offset(std::move(offset)), priority(priority) {}
+        : padding(std::move(insets)), offset(std::move(offset)), size_property(std::move(size)), priority(priority) {}
+};
+
+namespace detail {
+
+#if defined(VPACKCORE_INTRUSIVE_POINTER)
+
+/// The base of the elements, which holds their reference count.
+using NodeBase = ReferenceCounted;
+
+/// The pointer that owns an element.
+template<typename T>
+using NodePointer = IntrusivePointer<T>;
+
+/// A pointer that keeps an element alive on another thread than the one that owns it,
+/// created from a `NodePointer`.
+template<typename T>
+using NodeHandoff = HandoffPointer<T>;
+
+#else
+
+/// The base of the elements, empty unless the elements are owned by intrusive pointers.
+struct NodeBase {};
+
+/// The pointer that owns an element.
+///
+/// Elements are owned by `std::shared_ptr`s unless `VPACKCORE_INTRUSIVE_POINTER` is defined, which switches
+/// to `IntrusivePointer`s: a tree then needs no control blocks and no atomic operations to be built and destroyed,
+/// but its pointers must only be copied and destroyed by one thread at a time.
+template<typename T>
+using NodePointer = std::shared_ptr<T>;
+
+/// A pointer that keeps an element alive on another thread than the one that owns it,
+/// created from a `NodePointer`.
+template<typename T>
+using NodeHandoff = std::shared_ptr<T>;
+
+#endif
+
+/// The element types of the library, over which the closed-world mode dispatches without virtual calls.
+enum class NodeKind : uint8_t {
+    /// An element of any other type, including subclasses of the library's types.
+    custom,
+    item,
+    horizontal,
+    vertical,
+    stack,
+    decorated,
 };
 
+/// The kind if the node is exactly of its static type, otherwise `custom`, so that subclasses keep their overrides.
+template<typename Node>
+inline NodeKind kind_if_exact(const Node& node, NodeKind kind) {
+    return typeid(node) == typeid(Node) ? kind : NodeKind::custom;
+}
+
+template<typename Identifier, typename ValueType>
+struct NodeDispatch;
+
+}
+
 template<
     typename Identifier,
     typename ValueType,
     typename = std::enable_if<std::numeric_limits<ValueType>::has_infinity>
 >
-class Layoutable {
+class Layoutable;
+
+template<typename ValueType>
+class BatchMeasurable;
+
+namespace detail {
+
+template<typename Identifier, typename ValueType>
+class AffinePass;
+
+}
+
+/// Receives the frames of the child elements calculated by `Layoutable::arrange`.
+template<typename Identifier, typename ValueType>
+class ArrangeVisitor {
 public:
+    /// \param child The child element to be placed.
+    /// \param frame The frame of the child element.
+    /// \param lifted Whether the child element is lifted above all elements placed before it.
+    virtual void visit(const Layoutable<Identifier, ValueType>& child, const Rect<ValueType>& frame, bool lifted) = 0;
+
+protected:
+    ~ArrangeVisitor() = default;
+};
+
+template<typename Identifier, typename ValueType, typename>
+class Layoutable : public detail::NodeBase {
+public:
+    using ElementPointer = detail::NodePointer<Layoutable>;
+
     explicit Layoutable(LayoutParams<ValueType> p)
-        : params(p) {}
+        : params_(p) {}
 
-    virtual void layout(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const = 0;
+    /// Places the element and all of its descendants in the specified frame.
+    ///
+    /// The element must have been measured before it is placed. The default implementation calls `emit`
+    /// and places the children passed to `arrange` recursively. Subclasses implement `emit` and `arrange`
+    /// instead, which the placements of the library call directly. An element that overrides `layout`,
+    /// as elements did before `emit` and `arrange` were introduced, also overrides `places_subtree`
+    /// to be placed by its override as a whole.
+    virtual void layout(const Rect<ValueType>& frame, LayoutResult<Identifier, ValueType>& result) const;
+
+    /// Calculates the size the element needs within the specified size.
+    ///
+    /// The last measurement is cached for the measure pass of the installed context
+    /// (see `LayoutContext::begin_measure_pass`), measuring the element again with the same size in the same pass
+    /// returns the cached size and keeps the state that the element has prepared for `layout`.
+    /// Each measurement buffer (see `measure_buffer_count`) has its own cache. Without a context, nothing is cached.
+    ///
+    /// Subclasses implement `measure_content` instead. An element that overrides `measure`, as elements did
+    /// before `measure_content` was introduced, is measured by its override and caches nothing.
+    virtual Size<ValueType> measure(const Size<ValueType>& size);
+
+    /// Discards the cached measurements of the element and all of its descendants.
+    ///
+    /// Every layout measures in a new measure pass, so this only needs to be called in a context that retains
+    /// its measurements (see `LayoutContext::set_retains_measurements`), when something the measurement depends on
+    /// has changed, e.g. the content of a measurable.
+    void invalidate_measure_cache();
 
-    virtual Size<ValueType> measure(const Size<ValueType>& size) { return {}; }
+    /// The cached measurement of the element for the proposed size in the current measurement buffer, if any.
+    optional<Size<ValueType>> cached_measurement(const Size<ValueType>& size) const {
+        const MeasureCache& cache = measure_caches_[detail::current_measure_buffer()];
+        if (cache.holds_for(size, detail::current_measure_pass())) return cache.measured_size;
+        return nullopt;
+    }
 
-    /* The minimum or maximum values here indicate the element's own size attribute, excluding padding. */
+    /// Caches a measurement of the element that has been calculated outside of `measure`, e.g. in a batch.
+    ///
+    /// Only valid for elements whose measurement prepares no state, i.e. items.
+    void store_measurement(const Size<ValueType>& proposed_size, const Size<ValueType>& measured_size) {
+        measure_caches_[detail::current_measure_buffer()] = { proposed_size, measured_size,
+                                                              detail::current_measure_pass() };
+    }
 
-    ValueType min_width() const { return min_width_; }
+    /// The measurable of the element if it can be measured in a batch, see `BatchMeasurable`.
+    virtual const BatchMeasurable<ValueType>* batch_measurable() const { return nullptr; }
 
-    ValueType min_height() const { return min_height_; }
+    /// The child elements of the element, a leaf element has no child elements.
+    virtual std::span<const ElementPointer> child_elements() const { return {}; }
 
-    ValueType max_width() const { return max_width_; }
+    /// The kind of the element that the closed-world mode dispatches on, `custom` until it is resolved.
+    inline detail::NodeKind node_kind() const { return node_kind_; }
 
-    ValueType max_height() const { return max_height_; }
+    /// Resolves the kind of the element, called when the element is added to a container or a computer.
+    inline void resolve_node_kind() { node_kind_ = exact_node_kind(); }
 
-    inline EdgeInsets<ValueType> padding() const { return params.padding; }
+    /// Calculates the frames of the child elements when the element is placed in the specified frame,
+    /// and passes them to the visitor in placement order.
+    virtual void arrange(const Rect<ValueType>&, ArrangeVisitor<Identifier, ValueType>&) const {}
 
-    inline Point<ValueType> offset() const { return params.offset; }
+    /// Writes the layout attributes of the element itself to the layout result.
+    virtual void emit(const Rect<ValueType>&, LayoutResult<Identifier, ValueType>&) const {}
 
-    virtual ~Layoutable() = default;
+    /// Whether `layout` places the element and all of its descendants by itself, so the placements call it
+    /// instead of `emit` and `arrange`.
+    ///
+    /// Only read for elements of the kind `custom`. Elements that override `layout` return `true`.
+    virtual bool places_subtree() const { return false; }
+
+    /// Measures the element like `measure`, with a size that changes linearly with the size of the root frame.
+    ///
+    /// Called by the affine pass of `LayoutComputer::compute_resizable` after the element has been measured
+    /// with the value of the size. The default implementation requires the size to stay the same.
+    virtual Size<Affine<ValueType>> measure_affine(const Size<Affine<ValueType>>& size,
+                                                   detail::AffinePass<Identifier, ValueType>& pass);
+
+    /// Places the element and all of its descendants like `layout`, in a frame that changes linearly
+    /// with the size of the root frame.
+    ///
+    /// The default implementation requires the frame to stay the same.
+    virtual void layout_affine(const Rect<Affine<ValueType>>& frame,
+                               detail::AffinePass<Identifier, ValueType>& pass) const;
 
-    LayoutParams<ValueType> params;
+    /* The minimum or maximum values here indicate the element's own size attribute, excluding padding.
+     * They are calculated when one of them is first read, see `calculate_intrinsic_size`. */
+
+    ValueType min_width() const { return intrinsic_size().min.width; }
+
+    ValueType min_height() const { return intrinsic_size().min.height; }
+
+    ValueType max_width() const { return intrinsic_size().max.width; }
+
+    ValueType max_height() const { return intrinsic_size().max.height; }
+
+    /// Discards the minimum and maximum sizes of the element and all of its descendants,
+    /// they are calculated again when they are next read, together with their cached measurements.
+    ///
+    /// Needs to be called on the root of the tree when something that `calculate_intrinsic_size` depends on
+    /// has changed besides the parameters. Changes made with `set_size_property` and `set_padding`
+    /// are picked up by the next layout.
+    void invalidate_intrinsic_size();
+
+    /// The parameters of the element, which are changed with `set_size_property`, `set_padding`
+    /// and `set_offset`. The priority is fixed when the element is added to a container.
+    inline const LayoutParams<ValueType>& params() const { return params_; }
+
+    /// Changes the size property of the element, the next layout of its tree calculates the minimum
+    /// and maximum sizes of the element and its ancestors again, see `discard_changed_sizes`.
+    void set_size_property(const SizeProperty<ValueType>& size_property) {
+        params_.size_property = size_property;
+        mark_subtree_changed();
+    }
+
+    /// Changes the padding of the element, which changes the sizes of its ancestors like `set_size_property`.
+    void set_padding(const EdgeInsets<ValueType>& padding) {
+        params_.padding = padding;
+        mark_subtree_changed();
+    }
+
+    /// Changes the offset of the element, which only moves the element when it is placed.
+    void set_offset(const Point<ValueType>& offset) { params_.offset = offset; }
+
+    /// Discards the minimum and maximum sizes and the cached measurements of the elements in the subtree
+    /// that have been changed with `set_size_property` or `set_padding`, and of all of their ancestors
+    /// in the subtree.
+    ///
+    /// Called by the layouts on the root before they measure the tree. The setters mark the paths from
+    /// the changed elements to the root, so only the elements on these paths are visited, and an unchanged tree
+    /// costs a single check. An element shared by several containers marks the container it has been added to
+    /// last, the other roots have to be invalidated with `invalidate_intrinsic_size`.
+    ///
+    /// \return Whether an element in the subtree has been changed.
+    bool discard_changed_sizes();
+
+    inline EdgeInsets<ValueType> padding() const { return params_.padding; }
+
+    inline Point<ValueType> offset() const { return params_.offset; }
+
+    /// The number of elements in the subtree of the element, including the element itself.
+    inline std::size_t subtree_size() const { return subtree_size_; }
+
+    /// The number of elements in the subtree of the element that are lifted above the elements placed before them,
+    /// i.e. the amount by which placing the subtree raises the z-index of the layout result.
+    inline std::size_t subtree_lifts() const { return subtree_lifts_; }
+
+    /// The time it took to place the subtree of the element in previous layouts in nanoseconds,
+    /// smoothed over the layouts, or 0 if the placement of the subtree has never been timed.
+    inline float placement_cost() const { return placement_cost_.load(std::memory_order_relaxed); }
+
+    /// Blends a new timing of the placement of the subtree into `placement_cost`.
+    ///
+    /// \param smoothing The weight of the new timing, between 0 and 1.
+    void record_placement_cost(float nanoseconds, float smoothing) const {
+        const float cost = placement_cost_.load(std::memory_order_relaxed);
+        placement_cost_.store(cost == 0 ? nanoseconds : (1 - smoothing) * cost + smoothing * nanoseconds,
+                              std::memory_order_relaxed);
+    }
+
+    virtual ~Layoutable() = default;
 
     /// Resizes the specified size to the closest size that the element is suitable for display.
     ///
     /// The preferred size is not smaller than the minimum size of the element
     /// and does not exceed the maximum size of the element.
-    Size<ValueType> preferred_size(const Size<ValueType>& size) const {
+    Size<ValueType> preferred_size(const Size<ValueType>& size) const { return preferred_size<ValueType>(size); }
+
+    template<typename Scalar>
+    Size<Scalar> preferred_size(const Size<Scalar>& size) const {
+        using detail::min, detail::max;
         return {
-            std::max(static_cast<ValueType>(0), std::min(std::max(min_width(), size.width), max_width())),
-            std::max(static_cast<ValueType>(0), std::min(std::max(min_height(), size.height), max_height())),
+            max<Scalar>(0, min<Scalar>(max<Scalar>(min_width(), size.width), max_width())),
+            max<Scalar>(0, min<Scalar>(max<Scalar>(min_height(), size.height), max_height())),
         };
     }
 
 protected:
-    ValueType min_width_;
-    ValueType min_height_;
-    ValueType max_width_;
-    ValueType max_height_;
+    /// Calculates the size the element needs within the specified size.
+    ///
+    /// Subclasses implement their measurement here, `measure` only calls it when there is no cached result.
+    virtual Size<ValueType> measure_content(const Size<ValueType>&) { return {}; }
+
+    /// Discards the measurements that the element keeps in addition to the cache of `measure`.
+    ///
+    /// Called by `invalidate_measure_cache`.
+    virtual void discard_measurements() {}
+
+    /// The kind of the element if it is exactly one of the element types of the library, otherwise `custom`.
+    virtual detail::NodeKind exact_node_kind() const { return detail::NodeKind::custom; }
+
+    /// Makes the element the parent of the child element, which passes the changes in its subtree
+    /// to the element, see `discard_changed_sizes`. Called by containers for each of their children.
+    void adopt(Layoutable& child) {
+        child.parent_ = this;
+        if (child.subtree_changed_) mark_subtree_changed();
+    }
+
+    /// Detaches the child element from the element if it is its parent, called when the element is destroyed.
+    void release(Layoutable& child) {
+        if (child.parent_ == this) child.parent_ = nullptr;
+    }
+
+    /// Calculates the minimum and maximum sizes of the element.
+    ///
+    /// The default implementation uses the size property, without limits where it specifies none.
+    virtual IntrinsicSize<ValueType> calculate_intrinsic_size() const {
+        const SizeProperty<ValueType>& size_property = params_.size_property;
+        constexpr ValueType infinity = std::numeric_limits<ValueType>::infinity();
+        return {
+            { size_property.min_width.value_or(0), size_property.min_height.value_or(0) },
+            { size_property.max_width.value_or(infinity), size_property.max_height.value_or(infinity) },
+        };
+    }
+
+private:
+    friend struct detail::NodeDispatch<Identifier, ValueType>;
+
+    /// The minimum and maximum sizes of the element, calculated on first use.
+    ///
+    /// The whole tree is resolved by the first measurement of its root, which reads the sizes of the root
+    /// and thereby of all elements below. Like the measurement caches, the sizes must not be invalidated
+    /// while the tree is laid out, so concurrent layouts only ever read them.
+    inline const IntrinsicSize<ValueType>& intrinsic_size() const {
+        if (!intrinsic_size_resolved_) {
+            intrinsic_size_ = calculate_intrinsic_size();
+            intrinsic_size_resolved_ = true;
+        }
+        return intrinsic_size_;
+    }
+
+    /// Marks the element and its ancestors up to the first marked one as changed. The ancestors
+    /// of a marked element are marked as well, so the walk stops there.
+    void mark_subtree_changed() {
+        for (Layoutable* element = this; element && !element->subtree_changed_; element = element->parent_) {
+            element->subtree_changed_ = true;
+        }
+    }
+
+    /// Discards the minimum and maximum sizes and all measurements of the element itself.
+    void discard_sizes() {
+        intrinsic_size_resolved_ = false;
+        subtree_changed_ = false;
+        // The measurements have been calculated with the old sizes.
+        measure_caches_.for_each([](MeasureCache& cache) { cache.invalidate(); });
+        discard_measurements();
+    }
+
+    /// The last measurement of the element in a measurement buffer, which only holds in the measure pass
+    /// it has been calculated in.
+    struct MeasureCache {
+        Size<ValueType> proposed_size;
+        Size<ValueType> measured_size;
+        /// The measure pass of the measurement, 0 if the cache is invalid.
+        uint64_t pass = 0;
+
+        inline bool holds_for(const Size<ValueType>& size, uint64_t current_pass) const {
+            return current_pass != 0 && pass == current_pass && proposed_size == size;
+        }
+
+        inline void invalidate() { pass = 0; }
+    };
+
+    /* The data of the element is ordered by its use. The data read by every measurement comes first,
+     * so a measurement touches as few cache lines of the element as possible, followed by the parameters,
+     * which start with the padding (see `LayoutParams`), and the data only read by the placement. */
+
+private:
+    mutable IntrinsicSize<ValueType> intrinsic_size_;
+    mutable bool intrinsic_size_resolved_ = false;
+    /// Whether the size property or the padding of the element or of one of its descendants has been changed
+    /// since the last layout, see `mark_subtree_changed`.
+    bool subtree_changed_ = false;
+    detail::NodeKind node_kind_ = detail::NodeKind::custom;
+    detail::MeasureBuffers<MeasureCache> measure_caches_;
+    LayoutParams<ValueType> params_;
+    /// The container the element has been added to last, which is notified of its changes.
+    Layoutable* parent_ = nullptr;
+
+protected:
+    std::size_t subtree_size_ = 1;
+    std::size_t subtree_lifts_ = 0;
+
+private:
+    /// Written by the placement that times the subtree and read by the placement of the next layout,
+    /// which may run on another thread.
+    mutable std::atomic<float> placement_cost_{ 0 };
 };
 
 template<typename Identifier, typename ValueType>
-using LayoutablePointer = std::shared_ptr<Layoutable<Identifier, ValueType>>;
+using LayoutablePointer = detail::NodePointer<Layoutable<Identifier, ValueType>>;
+
+/// Creates an element of the specified type, owned by the kind of pointer the elements are owned by.
+template<typename T, typename... Args>
+detail::NodePointer<T> make_layoutable(Args&& ... args) {
+#if defined(VPACKCORE_INTRUSIVE_POINTER)
+    return make_intrusive<T>(std::forward<Args>(args)...);
+#else
+    return std::make_shared<T>(std::forward<Args>(args)...);
+#endif
+}
+
+namespace detail {
+
+template<typename Identifier, typename ValueType>
+struct RecursiveArrangeVisitor : public ArrangeVisitor<Identifier, ValueType> {
+    explicit RecursiveArrangeVisitor(LayoutResult<Identifier, ValueType>& result)
+        : result(result) {}
+
+    void visit(const Layoutable<Identifier, ValueType>& child, const Rect<ValueType>& frame, bool lifted) override {
+        if (lifted) result.max_z_idx += 1;
+        child.layout(frame, result);
+    }
+
+    LayoutResult<Identifier, ValueType>& result;
+};
+
+/// The state of the affine pass of `LayoutComputer::compute_resizable`.
+///
+/// The values of the pass are affine functions of the size of the root frame (see `Affine`), its comparisons
+/// record the sizes for which they keep their outcomes in the installed `AffineConstraints`.
+template<typename Identifier, typename ValueType>
+class AffinePass {
+public:
+    using Scalar = Affine<ValueType>;
+
+    /// The state that the affine measurement of a container prepares for its affine placement,
+    /// see `Container::MeasureState`.
+    struct MeasureState {
+        std::vector<Size<Scalar>> size_list;
+        Size<Scalar> cached_measured_size;
+    };
+
+    inline MeasureState& measure_state(const Layoutable<Identifier, ValueType>& element) {
+        return measure_states_[&element];
+    }
+
+    inline const MeasureState& measure_state(const Layoutable<Identifier, ValueType>& element) const {
+        return measure_states_.at(&element);
+    }
+
+    /// Records the frame of an item.
+    inline void emit(const Identifier& identifier, const Rect<Scalar>& frame) {
+        frames_.emplace_back(identifier, frame);
+    }
+
+    inline std::vector<std::pair<Identifier, Rect<Scalar>>>& frames() { return frames_; }
+
+private:
+    std::unordered_map<const Layoutable<Identifier, ValueType>*, MeasureState> measure_states_;
+    std::vector<std::pair<Identifier, Rect<Scalar>>> frames_;
+};
+
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+void Layoutable<Identifier, ValueType, Enable>::layout(const Rect<ValueType>& frame,
+                                                       LayoutResult<Identifier, ValueType>& result) const {
+    emit(frame, result);
+    detail::RecursiveArrangeVisitor<Identifier, ValueType> visitor(result);
+    arrange(frame, visitor);
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+Size<Affine<ValueType>>
+Layoutable<Identifier, ValueType, Enable>::measure_affine(const Size<Affine<ValueType>>& size,
+                                                          detail::AffinePass<Identifier, ValueType>&) {
+    detail::require_in_range(size.width, Range<ValueType>::exactly(size.width.value));
+    detail::require_in_range(size.height, Range<ValueType>::exactly(size.height.value));
+    const Size<ValueType> measured_size = measure({ size.width.value, size.height.value });
+    return { measured_size.width, measured_size.height };
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+void Layoutable<Identifier, ValueType, Enable>::layout_affine(const Rect<Affine<ValueType>>& frame,
+                                                              detail::AffinePass<Identifier, ValueType>& pass) const {
+    for (const Affine<ValueType>& value: { frame.x, frame.y, frame.width, frame.height }) {
+        detail::require_in_range(value, Range<ValueType>::exactly(value.value));
+    }
+    LayoutResult<Identifier, ValueType> result;
+    layout({ frame.x.value, frame.y.value, frame.width.value, frame.height.value }, result);
+    for (const auto& [identifier, attributes]: result.map) {
+        const Rect<ValueType>& child_frame = attributes.frame;
+        pass.emit(identifier, { child_frame.x, child_frame.y, child_frame.width, child_frame.height });
+    }
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+Size<ValueType> Layoutable<Identifier, ValueType, Enable>::measure(const Size<ValueType>& size) {
+    LayoutContext* context = LayoutContext::current();
+    MeasureCache& cache = measure_caches_[context ? context->measure_buffer() : 0];
+    const uint64_t pass = context ? context->measure_pass() : 0;
+    if (cache.holds_for(size, pass)) {
+        if (context) context->stats().cached_nodes += 1;
+        return cache.measured_size;
+    }
+    if (context && !context->consume()) return {};
+    const std::size_t deferred_measurement_count = context ? context->deferred_measurement_count() : 0;
+
+    // The state of the element is overwritten by the measurement,
+    // the cache must not outlive it if the measurement is interrupted.
+    cache.invalidate();
+#if defined(VPACKCORE_CLOSED_WORLD)
+    const Size<ValueType> measured_size = detail::NodeDispatch<Identifier, ValueType>::measure_content(*this, size);
+#else
+    const Size<ValueType> measured_size = measure_content(size);
+#endif
+    if (context) {
+        context->stats().measured_nodes += 1;
+        // An interrupted measurement of a descendant leaves the result incomplete.
+        if (context->interrupted()) return measured_size;
+        context->record_progress();
+        // The same holds for a measurement that depends on a deferred one, it has to be repeated.
+        if (context->deferred_measurement_count() != deferred_measurement_count) return measured_size;
+    }
+    cache = { size, measured_size, pass };
+    return measured_size;
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+void Layoutable<Identifier, ValueType, Enable>::invalidate_intrinsic_size() {
+    discard_sizes();
+    for (const auto& child: child_elements()) {
+        child->invalidate_intrinsic_size();
+    }
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+bool Layoutable<Identifier, ValueType, Enable>::discard_changed_sizes() {
+    if (!subtree_changed_) return false;
+    for (const auto& child: child_elements()) {
+        child->discard_changed_sizes();
+    }
+    discard_sizes();
+    return true;
+}
+
+template<typename Identifier, typename ValueType, typename Enable>
+void Layoutable<Identifier, ValueType, Enable>::invalidate_measure_cache() {
+    measure_caches_.for_each([](MeasureCache& cache) { cache.invalidate(); });
+    discard_measurements();
+    for (const auto& child: child_elements()) {
+        child->invalidate_measure_cache();
+    }
+}
 
 }
 
@@ -6,26 +6,94 @@
 #ifndef VPACKCORE_MEASURABLE_HPP
 #define VPACKCORE_MEASURABLE_HPP
 
+#include "../task.hpp"
 #include "../types.hpp"
+#include "../optional.hpp"
 
 namespace vpk::core {
 
+/// A measured size together with the proposed sizes it holds for.
+template<typename ValueType>
+struct Measurement {
+    Size<ValueType> size;
+    /// The proposed widths for which the measurement is the same.
+    Range<ValueType> width_range;
+    /// The proposed heights for which the measurement is the same.
+    Range<ValueType> height_range;
+
+    /// A measurement that only holds for the proposed size it has been measured with.
+    static Measurement exact(const Size<ValueType>& proposed_size, const Size<ValueType>& size) {
+        return { size, Range<ValueType>::exactly(proposed_size.width), Range<ValueType>::exactly(proposed_size.height) };
+    }
+
+    inline bool holds_for(const Size<ValueType>& proposed_size) const {
+        return width_range.contains(proposed_size.width) && height_range.contains(proposed_size.height);
+    }
+};
+
 template<typename ValueType>
 class Measurable {
 public:
     virtual Size<ValueType> measure(const Size<ValueType>& size) const = 0;
 
+    /// Measures the content and reports the proposed sizes for which the measured size stays the same.
+    ///
+    /// Content that only changes at a few breakpoints, e.g. a text that only changes when a line breaks
+    /// differently, should override this. Items keep the measurement until they are proposed a size outside
+    /// of its ranges, within a measure pass (see `LayoutContext::begin_measure_pass`).
+    /// The default implementation only holds for the proposed size.
+    virtual Measurement<ValueType> measure_with_validity(const Size<ValueType>& size) const {
+        return Measurement<ValueType>::exact(size, measure(size));
+    }
+
+    /// A key that identifies the content of the measurable, e.g. a hash of a text and its font.
+    ///
+    /// Measurables with the same key must measure to the same size for every proposed size. If a key is provided,
+    /// measurements are shared across elements and trees through `SharedMeasureCache::global`.
+    /// It is called for every measurement, so it should be cheap, e.g. computed once when the content is set.
+    virtual optional<std::size_t> content_key() const { return nullopt; }
+
+    /// Whether the measured size is always the proposed size, e.g. for spacers.
+    ///
+    /// The size of such content changes with the proposed size, which no range of `measure_with_validity`
+    /// can express. The affine pass of `LayoutComputer::compute_resizable` passes the proposed size through instead.
+    virtual bool measures_proposed_size() const { return false; }
+
     virtual ~Measurable() = default;
 };
 
+/// A measurable whose measurement is too slow to run on the layout thread, e.g. text shaping or
+/// reading the header of an image file.
+///
+/// The items of asynchronous measurables start their measurements concurrently in `LayoutComputer::compute_async`.
+/// Other layouts wait for each measurement in `measure`, which runs the coroutine on the waiting thread:
+/// its `resume_on` does not move it away, so a layout running on a worker of the executor never waits
+/// for a task queued behind itself. A coroutine that awaits other work, e.g. a task completed by another thread,
+/// still blocks the thread until that work has completed.
+template<typename ValueType>
+class AsyncMeasurable : public Measurable<ValueType> {
+public:
+    /// Starts measuring the content within the specified size.
+    ///
+    /// The measurement is started on the layout thread, it is expected to move its expensive part away,
+    /// e.g. with `co_await resume_on(executor)`.
+    virtual Task<Size<ValueType>> measure_async(const Size<ValueType>& size) const = 0;
+
+    Size<ValueType> measure(const Size<ValueType>& size) const override {
+        const detail::InlineResumption inline_resumption;
+        return measure_async(size).get();
+    }
+};
+
 template<typename ValueType>
 class AnyMeasurable : public Measurable<ValueType> {
 public:
     AnyMeasurable()
-        : measure_func([](const Size<ValueType>& size) { return size; }) {}
+        : measure_func([](const Size<ValueType>& size) { return size; }), kind(Kind::proposed) {}
 
-    AnyMeasurable(Size<ValueType> size) {
-        measure_func = [size](const Size<ValueType>& s) {
+    AnyMeasurable(Size<ValueType> size)
+        : kind(Kind::fixed) {
+        measure_func = [size](const Size<ValueType>&) {
             return size;
         };
     }
@@ -38,8 +106,27 @@ public:
         return measure_func(size);
     }
 
+    Measurement<ValueType> measure_with_validity(const Size<ValueType>& size) const override {
+        // A fixed size holds for every proposed size.
+        if (kind == Kind::fixed) {
+            return { measure_func(size), Range<ValueType>::unbounded(), Range<ValueType>::unbounded() };
+        }
+        return Measurable<ValueType>::measure_with_validity(size);
+    }
+
+    bool measures_proposed_size() const override { return kind == Kind::proposed; }
+
 private:
+    enum class Kind {
+        /// Measures to the proposed size.
+        proposed,
+        /// Measures to a fixed size.
+        fixed,
+        function,
+    };
+
     std::function<Size<ValueType>(Size<ValueType>)> measure_func;
+    Kind kind = Kind::function;
 };
 
 }
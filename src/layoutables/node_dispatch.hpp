@@ -0,0 +1,91 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_NODE_DISPATCH_HPP
+#define VPACKCORE_NODE_DISPATCH_HPP
+
+#include <type_traits>
+
+#include "item.hpp"
+#include "layoutable.hpp"
+#include "containers/stack_container.hpp"
+#include "containers/vertical_container.hpp"
+#include "containers/decorated_container.hpp"
+#include "containers/horizontal_container.hpp"
+
+namespace vpk::core::detail {
+
+/// Dispatches the functions of the elements over the closed set of the element types of the library.
+///
+/// The element types of the library form a tagged union over `NodeKind`. A switch on the kind of an element casts it
+/// to its exact type and calls the function of that type directly, which the compiler can inline across the kinds.
+/// Elements of other types, including subclasses of the library's types, have the kind `custom`
+/// and go through their virtual functions.
+///
+/// The measurement and the placement dispatch through it when `VPACKCORE_CLOSED_WORLD` is defined.
+template<typename Identifier, typename ValueType>
+struct NodeDispatch {
+    using Element = Layoutable<Identifier, ValueType>;
+
+    /// Calls the function with the element cast to its exact type, or with the element itself if it is custom.
+    ///
+    /// \param element A `Layoutable` or a `const Layoutable`, the cast keeps its constness.
+    template<typename Node, typename Function>
+    static decltype(auto) visit(Node& element, Function&& function) {
+        switch (element.node_kind()) {
+            case NodeKind::item:
+                return function(cast<Item<Identifier, ValueType>>(element));
+            case NodeKind::horizontal:
+                return function(cast<HorizontalContainer<Identifier, ValueType>>(element));
+            case NodeKind::vertical:
+                return function(cast<VerticalContainer<Identifier, ValueType>>(element));
+            case NodeKind::stack:
+                return function(cast<StackContainer<Identifier, ValueType>>(element));
+            case NodeKind::decorated:
+                return function(cast<DecoratedContainer<Identifier, ValueType>>(element));
+            case NodeKind::custom:
+                break;
+        }
+        return function(element);
+    }
+
+    static Size<ValueType> measure_content(Element& element, const Size<ValueType>& size) {
+        return visit(element, [&size]<typename Node>(Node& node) {
+            if constexpr (std::is_same_v<Node, Element>) {
+                return node.measure_content(size);
+            } else {
+                return node.Node::measure_content(size);
+            }
+        });
+    }
+
+    /// Writes the attributes of the element to the result and passes the frames of its children to the visitor.
+    static void place(const Element& element, const Rect<ValueType>& frame,
+                      LayoutResult<Identifier, ValueType>& result, ArrangeVisitor<Identifier, ValueType>& visitor) {
+        visit(element, [&]<typename Node>(const Node& node) {
+            if constexpr (std::is_same_v<Node, Element>) {
+                if (node.places_subtree()) {
+                    node.layout(frame, result);
+                    return;
+                }
+                node.emit(frame, result);
+                node.arrange(frame, visitor);
+            } else {
+                node.Node::emit(frame, result);
+                node.Node::arrange(frame, visitor);
+            }
+        });
+    }
+
+private:
+    template<typename T, typename Node>
+    static inline std::conditional_t<std::is_const_v<Node>, const T&, T&> cast(Node& element) {
+        return static_cast<std::conditional_t<std::is_const_v<Node>, const T&, T&>>(element);
+    }
+};
+
+}
+
+#endif //VPACKCORE_NODE_DISPATCH_HPP
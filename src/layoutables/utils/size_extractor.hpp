@@ -6,12 +6,12 @@
 #ifndef VPACKCORE_SIZE_EXTRACTOR_HPP
 #define VPACKCORE_SIZE_EXTRACTOR_HPP
 
-#include <version>
-#include <numeric>
+#include <span>
 #include <algorithm>
-#include <functional>
 
 #include "../layoutable.hpp"
+#include "../../utils/reduce.hpp"
+#include "../../utils/small_vector.hpp"
 
 namespace vpk::core {
 
@@ -20,45 +20,39 @@ enum class MinMaxPolicy {
     max
 };
 
-enum class SizeExtractor {
-    min_width,
-    max_width,
-    min_height,
-    max_height,
-};
-
-template<SizeExtractor se, typename Identifier, typename ValueType>
-ValueType extract(const LayoutablePointer<Identifier, ValueType>& ptr) {
-    const EdgeInsets<ValueType> padding = ptr->padding();
-    switch (se) {
-        case SizeExtractor::min_width:
-            return ptr->min_width() + padding.horizontal();
-        case SizeExtractor::max_width:
-            return ptr->max_width() + padding.horizontal();
-        case SizeExtractor::min_height:
-            return ptr->min_height() + padding.vertical();
-        case SizeExtractor::max_height:
-            return ptr->max_height() + padding.vertical();
+/// Calculates the minimum and maximum sizes of a container from the ones of its child elements.
+///
+/// The sizes of the elements include their paddings. The policies specify how the sizes along each axis are combined,
+/// e.g. a horizontal container sums the widths and takes the maximum of the heights. The sizes are gathered
+/// into a list per dimension and combined by the reductions of `reduce.hpp`, which are vectorized for `float`
+/// and `double`.
+template<typename Identifier, typename ValueType>
+IntrinsicSize<ValueType> calculate_intrinsic_size(std::span<const LayoutablePointer<Identifier, ValueType>> items,
+                                                  MinMaxPolicy width_policy, MinMaxPolicy height_policy) {
+    const std::size_t count = items.size();
+    SmallVector<ValueType, 16> extents(4 * count);
+    const std::span<ValueType> min_widths(extents.data(), count);
+    const std::span<ValueType> max_widths(extents.data() + count, count);
+    const std::span<ValueType> min_heights(extents.data() + 2 * count, count);
+    const std::span<ValueType> max_heights(extents.data() + 3 * count, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& item = items[i];
+        const EdgeInsets<ValueType> padding = item->padding();
+        const ValueType horizontal = padding.horizontal();
+        const ValueType vertical = padding.vertical();
+        min_widths[i] = item->min_width() + horizontal;
+        max_widths[i] = item->max_width() + horizontal;
+        min_heights[i] = item->min_height() + vertical;
+        max_heights[i] = item->max_height() + vertical;
     }
-}
 
-template<SizeExtractor se, typename Identifier, typename ValueType>
-ValueType calculate_min_max_dimension(const std::vector<LayoutablePointer<Identifier, ValueType>>& items,
-                                      const MinMaxPolicy& policy) {
-    std::vector<ValueType> dimensions;
-    std::transform(items.begin(), items.end(), std::back_inserter(dimensions),
-                   [](const auto& it) -> ValueType {
-                       return extract<se>(it);
-                   });
-    switch (policy) {
-        case MinMaxPolicy::sum:
-            return std::accumulate(dimensions.begin(), dimensions.end(), static_cast<ValueType>(0), std::plus<>());
-        case MinMaxPolicy::max: {
-            auto iter = std::max_element(dimensions.begin(), dimensions.end());
-            if (iter != dimensions.end()) return *iter;
-            else return static_cast<ValueType>(0);
-        }
-    }
+    const auto combine = [](MinMaxPolicy policy, std::span<const ValueType> values) {
+        return policy == MinMaxPolicy::sum ? reduce_sum<ValueType>(values) : reduce_max<ValueType>(values, 0);
+    };
+    return {
+        { combine(width_policy, min_widths), combine(height_policy, min_heights) },
+        { combine(width_policy, max_widths), combine(height_policy, max_heights) },
+    };
 }
 
 } // vpk
@@ -0,0 +1,219 @@
+//
+// Created by ktiays on 2022/9/14.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_MEASURE_CACHE_HPP
+#define VPACKCORE_MEASURE_CACHE_HPP
+
+#include <list>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "optional.hpp"
+
+namespace vpk::core {
+
+/// A thread-safe cache of measurements shared by all trees, keyed by the content of the measured leaves.
+///
+/// Leaves with the same content key must measure to the same size for the same proposed size, e.g. labels
+/// that show the same text in the same font. Items consult the global cache before measuring a measurable
+/// that provides a content key (see `Measurable::content_key`), so repeated content is only measured once
+/// per proposed size in the whole process.
+/// The cache holds as many entries as fit into its capacity and evicts the least recently used ones first.
+template<typename ValueType>
+class SharedMeasureCache {
+public:
+    struct Stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        /// The number of cached measurements.
+        std::size_t entries = 0;
+
+        /// The share of lookups answered by the cache.
+        double hit_rate() const {
+            const std::size_t lookups = hits + misses;
+            return lookups == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+    /// The approximate memory taken by one cached measurement, including the bookkeeping of the cache.
+    static constexpr std::size_t entry_size = sizeof(std::size_t) + 2 * sizeof(Size<ValueType>) + 6 * sizeof(void*);
+
+    static constexpr std::size_t default_capacity = 4 << 20;
+
+    /// \param capacity The maximum memory in bytes taken by the cached measurements.
+    explicit SharedMeasureCache(std::size_t capacity = default_capacity) {
+        set_capacity(capacity);
+    }
+
+    SharedMeasureCache(const SharedMeasureCache&) = delete;
+
+    SharedMeasureCache& operator =(const SharedMeasureCache&) = delete;
+
+    /// The cache consulted by items.
+    static SharedMeasureCache& global() {
+        static SharedMeasureCache cache;
+        return cache;
+    }
+
+    optional<Size<ValueType>> find(std::size_t content_key, const Size<ValueType>& proposed_size);
+
+    void insert(std::size_t content_key, const Size<ValueType>& proposed_size, const Size<ValueType>& measured_size);
+
+    inline std::size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+    /// Changes the capacity, evicting the least recently used measurements that do not fit anymore.
+    void set_capacity(std::size_t capacity);
+
+    void clear();
+
+    Stats stats() const;
+
+    /// Resets the counters of the statistics.
+    void reset_stats() {
+        hits_.store(0, std::memory_order_relaxed);
+        misses_.store(0, std::memory_order_relaxed);
+        evictions_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    /// The cache is split into shards with a lock each, so concurrent layouts rarely wait for each other.
+    static constexpr std::size_t shard_count = 16;
+
+    struct Key {
+        std::size_t content_key;
+        Size<ValueType> proposed_size;
+
+        inline bool operator ==(const Key& other) const {
+            return content_key == other.content_key && proposed_size == other.proposed_size;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator ()(const Key& key) const {
+            const std::hash<ValueType> hash;
+            std::size_t seed = key.content_key;
+            seed ^= hash(key.proposed_size.width) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= hash(key.proposed_size.height) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        /// The cached measurements, the most recently used one first.
+        std::list<std::pair<Key, Size<ValueType>>> entries;
+        std::unordered_map<Key, typename decltype(entries)::iterator, KeyHash> index;
+        std::size_t capacity = 0;
+
+        /// Evicts the least recently used measurements until the shard fits into its capacity.
+        ///
+        /// \return The number of evicted measurements.
+        std::size_t trim() {
+            std::size_t count = 0;
+            while (entries.size() > capacity) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+                count += 1;
+            }
+            return count;
+        }
+    };
+
+    std::array<Shard, shard_count> shards_;
+    std::atomic<std::size_t> capacity_{ 0 };
+    std::atomic<std::size_t> hits_{ 0 };
+    std::atomic<std::size_t> misses_{ 0 };
+    std::atomic<std::size_t> evictions_{ 0 };
+
+    inline Shard& shard(std::size_t hash) {
+        // The low bits select the bucket within the shard.
+        return shards_[(hash >> 16) % shard_count];
+    }
+};
+
+template<typename ValueType>
+optional<Size<ValueType>>
+SharedMeasureCache<ValueType>::find(std::size_t content_key, const Size<ValueType>& proposed_size) {
+    const Key key{ content_key, proposed_size };
+    const std::size_t hash = KeyHash{}(key);
+    Shard& shard = this->shard(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto iter = shard.index.find(key);
+        if (iter != shard.index.end()) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return iter->second->second;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullopt;
+}
+
+template<typename ValueType>
+void SharedMeasureCache<ValueType>::insert(std::size_t content_key, const Size<ValueType>& proposed_size,
+                                           const Size<ValueType>& measured_size) {
+    const Key key{ content_key, proposed_size };
+    const std::size_t hash = KeyHash{}(key);
+    Shard& shard = this->shard(hash);
+    std::size_t evictions;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.capacity == 0) return;
+        const auto iter = shard.index.find(key);
+        if (iter != shard.index.end()) {
+            iter->second->second = measured_size;
+            shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+            return;
+        }
+        shard.entries.emplace_front(key, measured_size);
+        shard.index.emplace(key, shard.entries.begin());
+        evictions = shard.trim();
+    }
+    if (evictions > 0) evictions_.fetch_add(evictions, std::memory_order_relaxed);
+}
+
+template<typename ValueType>
+void SharedMeasureCache<ValueType>::set_capacity(std::size_t capacity) {
+    capacity_.store(capacity, std::memory_order_relaxed);
+    const std::size_t shard_capacity = capacity / entry_size / shard_count;
+    for (Shard& shard: shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.capacity = shard_capacity;
+        evictions_.fetch_add(shard.trim(), std::memory_order_relaxed);
+    }
+}
+
+template<typename ValueType>
+void SharedMeasureCache<ValueType>::clear() {
+    for (Shard& shard: shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+    }
+}
+
+template<typename ValueType>
+typename SharedMeasureCache<ValueType>::Stats SharedMeasureCache<ValueType>::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const Shard& shard: shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+    }
+    return stats;
+}
+
+}
+
+#endif //VPACKCORE_MEASURE_CACHE_HPP
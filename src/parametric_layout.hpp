@@ -0,0 +1,83 @@
+//
+// Created by ktiays on 2022/9/16.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_PARAMETRIC_LAYOUT_HPP
+#define VPACKCORE_PARAMETRIC_LAYOUT_HPP
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+#include "types.hpp"
+#include "resizable_layout.hpp"
+
+namespace vpk::core {
+
+/// A layout of a fixed height as a piecewise affine function of the width of the root frame,
+/// see `LayoutComputer::compute_parametric`.
+///
+/// Each piece is a `ResizableLayout` that holds for a range of widths, the pieces are sorted by their widths
+/// and follow each other without gaps. Evaluating a width looks up its piece and evaluates the frames of the piece,
+/// which makes continuous resizing and previews of many widths cheap.
+template<typename Identifier, typename ValueType>
+class ParametricLayout {
+public:
+    explicit ParametricLayout(ValueType height)
+        : height_(height) {}
+
+    inline ValueType height() const { return height_; }
+
+    inline std::size_t piece_count() const { return pieces_.size(); }
+
+    /// The widths the layout can be evaluated for.
+    Range<ValueType> widths() const {
+        if (pieces_.empty()) return Range<ValueType>::none();
+        return { pieces_.front().widths.lower, pieces_.back().widths.upper };
+    }
+
+    inline bool covers(ValueType width) const { return widths().contains(width); }
+
+    /// The widths at which the structure of the layout changes, i.e. the widths where one piece ends
+    /// and the next one begins.
+    std::vector<ValueType> breakpoints() const {
+        std::vector<ValueType> breakpoints;
+        for (std::size_t i = 1; i < pieces_.size(); ++i) {
+            breakpoints.push_back(pieces_[i].widths.lower);
+        }
+        return breakpoints;
+    }
+
+    /// Calculates the layout for the specified width, which must be covered by the layout.
+    LayoutResult<Identifier, ValueType> evaluate(ValueType width) const;
+
+    /// Adds a piece after the last piece, starting where the last piece ends.
+    void append(const Range<ValueType>& widths, ResizableLayout<Identifier, ValueType> layout) {
+        assert(pieces_.empty() || widths.lower == pieces_.back().widths.upper);
+        pieces_.push_back({ widths, std::move(layout) });
+    }
+
+private:
+    struct Piece {
+        Range<ValueType> widths;
+        ResizableLayout<Identifier, ValueType> layout;
+    };
+
+    ValueType height_;
+    std::vector<Piece> pieces_;
+};
+
+template<typename Identifier, typename ValueType>
+LayoutResult<Identifier, ValueType> ParametricLayout<Identifier, ValueType>::evaluate(ValueType width) const {
+    assert(covers(width));
+    // The last piece that starts at or before the width.
+    const auto iter = std::upper_bound(pieces_.begin(), pieces_.end(), width, [](ValueType width, const Piece& piece) {
+        return width < piece.widths.lower;
+    });
+    return std::prev(iter)->layout.update({ 0, 0, width, height_ });
+}
+
+}
+
+#endif //VPACKCORE_PARAMETRIC_LAYOUT_HPP
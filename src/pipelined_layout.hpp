@@ -0,0 +1,205 @@
+//
+// Created by ktiays on 2022/9/8.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_PIPELINED_LAYOUT_HPP
+#define VPACKCORE_PIPELINED_LAYOUT_HPP
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <future>
+#include <exception>
+#include <condition_variable>
+
+#include "computer.hpp"
+#include "executor.hpp"
+#include "layout_context.hpp"
+
+namespace vpk::core {
+
+/// Lays out a sequence of frames of one tree, e.g. the frames of an animation, in a two-stage pipeline.
+///
+/// The measurement of a frame runs in one task of the executor while the placement of the previous frame
+/// runs in another. Each stage works on its own measurement buffer (see `measure_buffer_count`), so the
+/// measurement of the next frame never touches the state the placement is reading.
+/// Requests are completed in submission order. Without an executor, each request is measured and placed
+/// on the thread that submits it. The tree must not be laid out by anything else while it is owned by the pipeline.
+/// Sizes changed with `Layoutable::set_size_property` or `Layoutable::set_padding` while no request is pending
+/// are picked up by the next request.
+template<typename Identifier, typename ValueType>
+class PipelinedLayout {
+public:
+    explicit PipelinedLayout(LayoutablePointer<Identifier, ValueType> item, Executor* executor = nullptr)
+        : item_(std::move(item)), executor_(executor) {
+        item_->resolve_node_kind();
+    }
+
+    PipelinedLayout(const PipelinedLayout&) = delete;
+
+    PipelinedLayout& operator =(const PipelinedLayout&) = delete;
+
+    /// Stops the pipeline, the futures of requests that have not completed become broken.
+    ~PipelinedLayout();
+
+    /// Requests a layout of the tree in the specified frame.
+    ///
+    /// If the layout throws, the future rethrows the exception and the following requests are laid out as usual.
+    std::future<LayoutResult<Identifier, ValueType>> submit(const Rect<ValueType>& frame);
+
+private:
+    struct Request {
+        Rect<ValueType> frame;
+        std::promise<LayoutResult<Identifier, ValueType>> promise;
+    };
+
+    struct MeasuredRequest {
+        Request request;
+        /// The frame of the root element calculated by the measurement.
+        Rect<ValueType> root_frame;
+        std::size_t buffer;
+        /// The exception of a failed measurement, which is passed to the promise in submission order.
+        std::exception_ptr exception;
+    };
+
+    LayoutablePointer<Identifier, ValueType> item_;
+    Executor* executor_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Request> requests_;
+    std::deque<MeasuredRequest> measured_requests_;
+    /// Whether a buffer holds a measurement that has not been placed yet.
+    std::array<bool, measure_buffer_count> buffer_in_use_{};
+    std::size_t next_buffer_ = 0;
+    /// Whether a task of the stage has been scheduled.
+    bool measuring_ = false;
+    bool placing_ = false;
+    bool stopping_ = false;
+
+    /// Whether the measure stage has work it can start, must be called with the mutex locked.
+    inline bool can_measure() const {
+        return !stopping_ && !requests_.empty() && !buffer_in_use_[next_buffer_];
+    }
+
+    void schedule(void (PipelinedLayout::*stage)()) {
+        if (executor_) executor_->execute([this, stage] { (this->*stage)(); });
+        else (this->*stage)();
+    }
+
+    void run_measure();
+
+    void run_placement();
+};
+
+template<typename Identifier, typename ValueType>
+PipelinedLayout<Identifier, ValueType>::~PipelinedLayout() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    condition_.wait(lock, [this] { return !measuring_ && !placing_; });
+}
+
+template<typename Identifier, typename ValueType>
+std::future<LayoutResult<Identifier, ValueType>>
+PipelinedLayout<Identifier, ValueType>::submit(const Rect<ValueType>& frame) {
+    Request request{ frame, {}};
+    auto future = request.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back(std::move(request));
+        if (measuring_ || !can_measure()) return future;
+        measuring_ = true;
+    }
+    schedule(&PipelinedLayout::run_measure);
+    return future;
+}
+
+template<typename Identifier, typename ValueType>
+void PipelinedLayout<Identifier, ValueType>::run_measure() {
+    while (true) {
+        Request request;
+        std::size_t buffer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // The next buffer can only be measured into after its previous measurement has been placed,
+            // the placement stage schedules the measure stage again when it releases the buffer.
+            if (!can_measure()) {
+                measuring_ = false;
+                condition_.notify_all();
+                return;
+            }
+            request = std::move(requests_.front());
+            requests_.pop_front();
+            buffer = next_buffer_;
+            next_buffer_ = (next_buffer_ + 1) % measure_buffer_count;
+            buffer_in_use_[buffer] = true;
+        }
+
+        Rect<ValueType> root_frame;
+        std::exception_ptr exception;
+        try {
+            LayoutContext context;
+            context.set_measure_buffer(buffer);
+            context.begin_measure_pass();
+            LayoutContext::Scope scope(context);
+            item_->discard_changed_sizes();
+            const Size<ValueType> size = detail::measure_root(*item_, request.frame);
+            root_frame = detail::root_frame(*item_, request.frame, size);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        bool should_place = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            measured_requests_.push_back({ std::move(request), root_frame, buffer, std::move(exception) });
+            if (!placing_) should_place = placing_ = true;
+        }
+        if (should_place) schedule(&PipelinedLayout::run_placement);
+    }
+}
+
+template<typename Identifier, typename ValueType>
+void PipelinedLayout<Identifier, ValueType>::run_placement() {
+    while (true) {
+        optional<MeasuredRequest> measured;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || measured_requests_.empty()) {
+                placing_ = false;
+                condition_.notify_all();
+                return;
+            }
+            measured = std::move(measured_requests_.front());
+            measured_requests_.pop_front();
+        }
+
+        LayoutResult<Identifier, ValueType> result;
+        std::exception_ptr exception = std::move(measured->exception);
+        if (!exception) {
+            try {
+                LayoutContext context;
+                context.set_measure_buffer(measured->buffer);
+                LayoutContext::Scope scope(context);
+                detail::PlacementStack<Identifier, ValueType> placement;
+                placement.push(*item_, measured->root_frame);
+                placement.run(result);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+        }
+        bool should_measure = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffer_in_use_[measured->buffer] = false;
+            if (!measuring_ && can_measure()) should_measure = measuring_ = true;
+        }
+        if (exception) measured->request.promise.set_exception(std::move(exception));
+        else measured->request.promise.set_value(std::move(result));
+        if (should_measure) schedule(&PipelinedLayout::run_measure);
+    }
+}
+
+}
+
+#endif //VPACKCORE_PIPELINED_LAYOUT_HPP
@@ -0,0 +1,102 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_PIXEL_SNAPPING_HPP
+#define VPACKCORE_PIXEL_SNAPPING_HPP
+
+#include <span>
+#include <cmath>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "types.hpp"
+#include "layout_result.hpp"
+
+namespace vpk::core {
+
+/// Rounds the frames to the pixel grid of a display with the specified scale factor, e.g. 2 or 1.5 device pixels
+/// per unit.
+///
+/// The edges of a frame are rounded, not its size: each edge moves to the nearest device pixel, rounding halves
+/// to even, and the size is the distance between the rounded edges. Adjacent frames share their edges,
+/// so they stay adjacent without gaps or overlaps. An edge exactly halfway between two device pixels
+/// is rounded the same way in every frame.
+///
+/// With AVX2 enabled (e.g. `-mavx2`), a frame of `double`s or two frames of `float`s are rounded per instruction,
+/// with the same result as the scalar loop.
+template<typename ValueType>
+void snap_to_pixels(std::span<Rect<ValueType>> frames, ValueType scale) {
+    static_assert(std::is_floating_point_v<ValueType>, "Only floating-point frames are rounded to pixels.");
+    static_assert(sizeof(Rect<ValueType>) == 4 * sizeof(ValueType));
+
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<ValueType, double>) {
+        const __m256d scales = _mm256_set1_pd(scale);
+        for (; i < frames.size(); ++i) {
+            double* frame = &frames[i].x;
+            const __m256d rect = _mm256_loadu_pd(frame);
+            // (x, y, width, height) + (0, 0, x, y) is (min_x, min_y, max_x, max_y).
+            const __m256d edges = _mm256_add_pd(rect, _mm256_permute2f128_pd(rect, rect, 0x08));
+            const __m256d snapped = _mm256_div_pd(
+                _mm256_round_pd(_mm256_mul_pd(edges, scales), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC),
+                scales
+            );
+            _mm256_storeu_pd(frame, _mm256_sub_pd(snapped, _mm256_permute2f128_pd(snapped, snapped, 0x08)));
+        }
+    } else if constexpr (std::is_same_v<ValueType, float>) {
+        const __m256 scales = _mm256_set1_ps(scale);
+        // The byte shift moves the origin of each of the two frames into the upper half of its lane.
+        const auto origins = [](__m256 rects) {
+            return _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(rects), 8));
+        };
+        for (; i + 2 <= frames.size(); i += 2) {
+            float* frame = &frames[i].x;
+            const __m256 rects = _mm256_loadu_ps(frame);
+            const __m256 edges = _mm256_add_ps(rects, origins(rects));
+            const __m256 snapped = _mm256_div_ps(
+                _mm256_round_ps(_mm256_mul_ps(edges, scales), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC),
+                scales
+            );
+            _mm256_storeu_ps(frame, _mm256_sub_ps(snapped, origins(snapped)));
+        }
+    }
+#endif
+    // `std::nearbyint` rounds halves to even in the default rounding mode, like the vector rounding.
+    for (; i < frames.size(); ++i) {
+        Rect<ValueType>& frame = frames[i];
+        const ValueType min_x = std::nearbyint(frame.x * scale) / scale;
+        const ValueType min_y = std::nearbyint(frame.y * scale) / scale;
+        const ValueType max_x = std::nearbyint((frame.x + frame.width) * scale) / scale;
+        const ValueType max_y = std::nearbyint((frame.y + frame.height) * scale) / scale;
+        frame = { min_x, min_y, max_x - min_x, max_y - min_y };
+    }
+}
+
+/// Rounds the frames of the layout result to the pixel grid, see `snap_to_pixels`.
+///
+/// The frames are gathered into a dense list, rounded in one pass and written back.
+template<typename Identifier, typename ValueType>
+void snap_to_pixels(LayoutResult<Identifier, ValueType>& result, ValueType scale) {
+    std::vector<Rect<ValueType>> frames;
+    frames.reserve(result.map.size());
+    for (const auto& [identifier, attributes]: result.map) {
+        frames.push_back(attributes.frame);
+    }
+    snap_to_pixels<ValueType>(frames, scale);
+    auto frame = frames.begin();
+    for (auto& [identifier, attributes]: result.map) {
+        attributes.frame = *frame++;
+    }
+}
+
+}
+
+#endif //VPACKCORE_PIXEL_SNAPPING_HPP
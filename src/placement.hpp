@@ -0,0 +1,326 @@
+//
+// Created by ktiays on 2022/9/11.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_PLACEMENT_HPP
+#define VPACKCORE_PLACEMENT_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "executor.hpp"
+#include "layout_result.hpp"
+#include "layout_context.hpp"
+#include "layoutables/layoutable.hpp"
+
+namespace vpk::core {
+
+/// Controls how `LayoutComputer::compute_parallel` splits the placement of a tree.
+///
+/// The decisions are based on the estimated cost of placing each subtree. A subtree that has been placed
+/// by a parallel placement before is estimated with its smoothed timing (see `Layoutable::placement_cost`),
+/// any other subtree with its number of elements.
+struct ParallelPlacementOptions {
+    /// Subtrees with fewer elements are never split, whatever their estimated cost is.
+    std::size_t min_subtree_size = 64;
+    /// The estimated cost a task needs to reach to be forked, cheaper tasks cost more to schedule than to run.
+    std::chrono::nanoseconds min_task_cost{ 20000 };
+    /// The estimated cost of placing one element of a subtree that has never been timed.
+    std::chrono::nanoseconds default_element_cost{ 100 };
+    /// Whether runs of small sibling subtrees are placed together by one task
+    /// once their estimated costs add up to `min_task_cost`.
+    bool batch_siblings = true;
+    /// The weight of the newest timing of a subtree in its estimated cost, between 0 and 1.
+    float cost_smoothing = 0.25f;
+};
+
+}
+
+namespace vpk::core::detail {
+
+/// Places elements with an explicit work stack instead of recursion,
+/// so the placement can stop between two elements and continue later.
+template<typename Identifier, typename ValueType>
+class PlacementStack : public ArrangeVisitor<Identifier, ValueType> {
+public:
+    inline bool empty() const { return entries_.empty(); }
+
+    void push(const Layoutable<Identifier, ValueType>& element, const Rect<ValueType>& frame, bool lifted = false) {
+        entries_.push_back({ &element, frame, lifted });
+    }
+
+    /// Places the elements on the stack in depth-first order.
+    ///
+    /// \return Whether all elements have been placed, `false` if the current context interrupted the placement.
+    bool run(LayoutResult<Identifier, ValueType>& result) {
+        LayoutContext* context = LayoutContext::current();
+        while (!entries_.empty()) {
+            if (context && !context->consume()) return false;
+            const Entry entry = entries_.back();
+            entries_.pop_back();
+
+            if (entry.lifted) result.max_z_idx += 1;
+            // The children are visited in placement order, reverse them so that the first child is on the top.
+            const auto first_child = entries_.size();
+#if defined(VPACKCORE_CLOSED_WORLD)
+            detail::NodeDispatch<Identifier, ValueType>::place(*entry.element, entry.frame, result, *this);
+#else
+            if (entry.element->node_kind() == NodeKind::custom && entry.element->places_subtree()) {
+                entry.element->layout(entry.frame, result);
+            } else {
+                entry.element->emit(entry.frame, result);
+                entry.element->arrange(entry.frame, *this);
+            }
+#endif
+            std::reverse(entries_.begin() + static_cast<std::ptrdiff_t>(first_child), entries_.end());
+            if (context) {
+                context->stats().placed_nodes += 1;
+                context->record_progress();
+            }
+        }
+        return true;
+    }
+
+    void visit(const Layoutable<Identifier, ValueType>& child, const Rect<ValueType>& frame, bool lifted) override {
+        push(child, frame, lifted);
+    }
+
+private:
+    struct Entry {
+        const Layoutable<Identifier, ValueType>* element;
+        Rect<ValueType> frame;
+        bool lifted;
+    };
+
+    std::vector<Entry> entries_;
+};
+
+/// Places the subtrees of a tree concurrently.
+///
+/// The children of an element are placed in order. A child whose subtree is expensive enough is placed by a task
+/// into a result shard of its own, a run of cheap siblings is either batched into one task or placed into the shard
+/// of the parent. The z-index a subtree starts from only depends on the number of lifts placed before it, which is
+/// known from `subtree_lifts` without placing them, so every element gets the same z-index as in a serial placement.
+/// Placement does not change the tree, so the tasks only share the measurement buffer they read from.
+template<typename Identifier, typename ValueType>
+class ParallelPlacement {
+public:
+    ParallelPlacement(Executor* executor, const ParallelPlacementOptions& options)
+        : executor_(executor), options_(options), measure_buffer_(current_measure_buffer()) {}
+
+    /// Places the element and its subtree into the result.
+    void run(const Layoutable<Identifier, ValueType>& element, const Rect<ValueType>& frame,
+             LayoutResult<Identifier, ValueType>& result);
+
+private:
+    using Element = Layoutable<Identifier, ValueType>;
+    using Result = LayoutResult<Identifier, ValueType>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Child {
+        const Element* element;
+        Rect<ValueType> frame;
+        bool lifted;
+        /// The estimated cost of placing the subtree of the child in nanoseconds.
+        double cost;
+    };
+
+    class ChildCollector : public ArrangeVisitor<Identifier, ValueType> {
+    public:
+        std::vector<Child> children;
+
+        void visit(const Element& child, const Rect<ValueType>& frame, bool lifted) override {
+            children.push_back({ &child, frame, lifted, 0 });
+        }
+    };
+
+    Executor* executor_;
+    ParallelPlacementOptions options_;
+    std::size_t measure_buffer_;
+
+    std::mutex mutex_;
+    /// The results of the forked subtrees, a deque never relocates a shard that a task is writing to.
+    std::deque<Result> shards_;
+    std::atomic<std::size_t> placed_nodes_{ 0 };
+    std::atomic<std::size_t> subtree_tasks_{ 0 };
+    std::atomic<std::size_t> batch_tasks_{ 0 };
+    std::atomic<std::size_t> serial_subtrees_{ 0 };
+
+    inline double min_task_cost() const {
+        return static_cast<double>(options_.min_task_cost.count());
+    }
+
+    double estimate(const Element& element) const {
+        const float cost = element.placement_cost();
+        if (cost > 0) return cost;
+        return static_cast<double>(element.subtree_size()) * static_cast<double>(options_.default_element_cost.count());
+    }
+
+    /// Whether it pays off to place the children of the element in more than one task.
+    inline bool splits(const Element& element, double cost) const {
+        return executor_ && element.subtree_size() >= options_.min_subtree_size && cost >= 2 * min_task_cost();
+    }
+
+    Result& make_shard(uint16_t z_idx) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Result& shard = shards_.emplace_back();
+        shard.max_z_idx = z_idx;
+        return shard;
+    }
+
+    /// The amount by which placing the children raises the z-index.
+    static uint16_t lifts(const Child* begin, const Child* end) {
+        std::size_t count = 0;
+        for (const Child* child = begin; child != end; ++child) {
+            count += (child->lifted ? 1 : 0) + child->element->subtree_lifts();
+        }
+        return static_cast<uint16_t>(count);
+    }
+
+    /// Places a run of sibling subtrees in a context of its own, which reads from the measurement buffer
+    /// of the layout.
+    ///
+    /// \return The time spent placing the subtrees in nanoseconds.
+    double place_task(const Child* begin, const Child* end, Result& shard) {
+        LayoutContext context;
+        context.set_measure_buffer(measure_buffer_);
+        LayoutContext::Scope scope(context);
+        double cost = 0;
+        for (const Child* child = begin; child != end; ++child) {
+            if (child->lifted) shard.max_z_idx += 1;
+            cost += place(*child->element, child->frame, shard, child->cost);
+        }
+        placed_nodes_.fetch_add(context.stats().placed_nodes, std::memory_order_relaxed);
+        return cost;
+    }
+
+    /// Places the subtree of the element, and records the time it took in the element.
+    ///
+    /// \return The time spent placing the subtree in nanoseconds, summed over all tasks.
+    double place(const Element& element, const Rect<ValueType>& frame, Result& shard, double estimated_cost);
+};
+
+template<typename Identifier, typename ValueType>
+void ParallelPlacement<Identifier, ValueType>::run(const Element& element, const Rect<ValueType>& frame,
+                                                   Result& result) {
+    const Child root{ &element, frame, false, estimate(element) };
+    const double cost = place_task(&root, &root + 1, result);
+    std::size_t size = result.map.size();
+    for (const Result& shard: shards_) {
+        size += shard.map.size();
+    }
+    result.map.reserve(size);
+    for (Result& shard: shards_) {
+        result.map.merge(shard.map);
+    }
+    shards_.clear();
+
+    LayoutContext* context = LayoutContext::current();
+    if (!context) return;
+    LayoutStats& stats = context->stats();
+    stats.placed_nodes += placed_nodes_.exchange(0, std::memory_order_relaxed);
+    ParallelPlacementStats& parallel = stats.parallel;
+    parallel.subtree_tasks += subtree_tasks_.exchange(0, std::memory_order_relaxed);
+    parallel.batch_tasks += batch_tasks_.exchange(0, std::memory_order_relaxed);
+    parallel.serial_subtrees += serial_subtrees_.exchange(0, std::memory_order_relaxed);
+    parallel.estimated_cost += std::chrono::nanoseconds(static_cast<std::int64_t>(root.cost));
+    parallel.measured_cost += std::chrono::nanoseconds(static_cast<std::int64_t>(cost));
+    parallel.min_task_cost = options_.min_task_cost;
+}
+
+template<typename Identifier, typename ValueType>
+double ParallelPlacement<Identifier, ValueType>::place(const Element& element, const Rect<ValueType>& frame,
+                                                       Result& shard, double estimated_cost) {
+    const Clock::time_point start = Clock::now();
+    if (!splits(element, estimated_cost)) {
+        PlacementStack<Identifier, ValueType> placement;
+        placement.push(element, frame);
+        placement.run(shard);
+        serial_subtrees_.fetch_add(1, std::memory_order_relaxed);
+        const double cost = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        element.record_placement_cost(static_cast<float>(cost), options_.cost_smoothing);
+        return cost;
+    }
+
+    // An element that overrides `layout` places its subtree by itself.
+    if (element.node_kind() == NodeKind::custom && element.places_subtree()) {
+        element.layout(frame, shard);
+        const double cost = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        element.record_placement_cost(static_cast<float>(cost), options_.cost_smoothing);
+        return cost;
+    }
+    element.emit(frame, shard);
+    LayoutContext::current()->stats().placed_nodes += 1;
+    ChildCollector collector;
+    element.arrange(frame, collector);
+    std::vector<Child>& children = collector.children;
+    for (Child& child: children) {
+        child.cost = estimate(*child.element);
+    }
+
+    // The time of the forked tasks is summed instead of measuring the time spent waiting for them.
+    std::vector<double> task_costs;
+    task_costs.reserve(children.size());
+    Clock::duration wait_time{};
+    {
+        TaskGroup group(executor_);
+        const Child* const data = children.data();
+        std::size_t begin = 0;
+        double batch_cost = 0;
+        // Forks the children from `begin` to `end` if they are worth a task, or places them right away.
+        const auto flush = [&](std::size_t end) {
+            if (begin == end) return;
+            if (batch_cost >= min_task_cost()) {
+                Result& task_shard = make_shard(shard.max_z_idx);
+                double& task_cost = task_costs.emplace_back(0);
+                group.run([this, first = data + begin, last = data + end, &task_shard, &task_cost] {
+                    task_cost = place_task(first, last, task_shard);
+                });
+                (end - begin > 1 ? batch_tasks_ : subtree_tasks_).fetch_add(1, std::memory_order_relaxed);
+                // Skip the z-indices the forked subtrees are going to use.
+                shard.max_z_idx += lifts(data + begin, data + end);
+            } else {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const Child& child = children[i];
+                    if (child.lifted) shard.max_z_idx += 1;
+                    place(*child.element, child.frame, shard, child.cost);
+                }
+            }
+            begin = end;
+            batch_cost = 0;
+        };
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            if (children[i].cost >= min_task_cost()) {
+                // The run of cheap siblings before the child goes to a task only if it is worth one on its own.
+                flush(i);
+                batch_cost = children[i].cost;
+                flush(i + 1);
+            } else {
+                batch_cost += children[i].cost;
+                if (!options_.batch_siblings || batch_cost >= min_task_cost()) flush(i + 1);
+            }
+        }
+        flush(children.size());
+
+        const Clock::time_point wait_start = Clock::now();
+        group.wait();
+        wait_time = Clock::now() - wait_start;
+    }
+
+    double cost = std::chrono::duration<double, std::nano>(Clock::now() - start - wait_time).count();
+    for (const double task_cost: task_costs) {
+        cost += task_cost;
+    }
+    element.record_placement_cost(static_cast<float>(cost), options_.cost_smoothing);
+    return cost;
+}
+
+}
+
+#endif //VPACKCORE_PLACEMENT_HPP
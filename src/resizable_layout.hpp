@@ -0,0 +1,80 @@
+//
+// Created by ktiays on 2022/9/15.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_RESIZABLE_LAYOUT_HPP
+#define VPACKCORE_RESIZABLE_LAYOUT_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "types.hpp"
+#include "affine.hpp"
+#include "layout_result.hpp"
+
+namespace vpk::core {
+
+/// A layout result together with the sizes of the root frame for which the result keeps its structure,
+/// see `LayoutComputer::compute_resizable`.
+///
+/// Within these sizes every frame of the result is an affine function of the size of the root frame,
+/// so resizing the root frame only needs `update`, which evaluates the functions without measuring anything.
+template<typename Identifier, typename ValueType>
+class ResizableLayout {
+public:
+    /// The frame of an item as a function of the size of the root frame.
+    struct Entry {
+        Identifier identifier;
+        Rect<Affine<ValueType>> frame;
+        uint16_t z_idx;
+    };
+
+    /// \param size The size of the root frame the layout has been computed in.
+    ResizableLayout(LayoutResult<Identifier, ValueType> result, const Size<ValueType>& size,
+                    const LayoutValidity<ValueType>& validity, std::vector<Entry> entries)
+        : result_(std::move(result)), size_(size), validity_(validity), entries_(std::move(entries)) {}
+
+    /// The result of the layout in the frame it has been computed in.
+    inline const LayoutResult<Identifier, ValueType>& result() const { return result_; }
+
+    inline const LayoutValidity<ValueType>& validity() const { return validity_; }
+
+    /// Whether `update` can calculate the layout in the specified frame.
+    inline bool holds_for(const Rect<ValueType>& frame) const { return validity_.contains(frame.size()); }
+
+    /// Calculates the layout in the specified frame, which must be within the validity of the layout.
+    LayoutResult<Identifier, ValueType> update(const Rect<ValueType>& frame) const;
+
+private:
+    LayoutResult<Identifier, ValueType> result_;
+    Size<ValueType> size_;
+    LayoutValidity<ValueType> validity_;
+    std::vector<Entry> entries_;
+};
+
+template<typename Identifier, typename ValueType>
+LayoutResult<Identifier, ValueType> ResizableLayout<Identifier, ValueType>::update(const Rect<ValueType>& frame) const {
+    const ValueType width_delta = frame.width - size_.width;
+    const ValueType height_delta = frame.height - size_.height;
+    LayoutResult<Identifier, ValueType> result;
+    result.max_z_idx = result_.max_z_idx;
+    result.map.reserve(entries_.size());
+    for (const Entry& entry: entries_) {
+        const Rect<Affine<ValueType>>& affine_frame = entry.frame;
+        result.map.emplace(entry.identifier, LayoutAttributes<ValueType>{
+            .frame = {
+                affine_frame.x.at(width_delta, height_delta),
+                affine_frame.y.at(width_delta, height_delta),
+                affine_frame.width.at(width_delta, height_delta),
+                affine_frame.height.at(width_delta, height_delta),
+            },
+            .z_idx = entry.z_idx
+        });
+    }
+    return result;
+}
+
+}
+
+#endif //VPACKCORE_RESIZABLE_LAYOUT_HPP
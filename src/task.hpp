@@ -0,0 +1,292 @@
+//
+// Created by ktiays on 2022/9/12.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_TASK_HPP
+#define VPACKCORE_TASK_HPP
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <exception>
+#include <coroutine>
+#include <condition_variable>
+
+#include "executor.hpp"
+#include "optional.hpp"
+
+namespace vpk::core {
+
+template<typename T>
+class Task;
+
+namespace detail {
+
+/// The completion state shared by a coroutine of a `Task` and everything waiting for it.
+class TaskStateBase {
+public:
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return done_;
+    }
+
+    /// Blocks the calling thread until the task has completed.
+    void wait() const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return done_; });
+    }
+
+    /// Makes the coroutine resume when the task completes.
+    ///
+    /// \return `false` if the task has already completed, the coroutine must not be suspended in that case.
+    bool add_continuation(std::coroutine_handle<> continuation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_) return false;
+        continuations_.push_back(continuation);
+        return true;
+    }
+
+    void set_exception(std::exception_ptr exception) {
+        exception_ = std::move(exception);
+        complete();
+    }
+
+protected:
+    void complete() {
+        std::vector<std::coroutine_handle<>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = true;
+            std::swap(continuations, continuations_);
+            condition_.notify_all();
+        }
+        for (const auto continuation: continuations) {
+            continuation.resume();
+        }
+    }
+
+    void rethrow_if_failed() const {
+        if (exception_) std::rethrow_exception(exception_);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable condition_;
+    bool done_ = false;
+    std::vector<std::coroutine_handle<>> continuations_;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+class TaskState : public TaskStateBase {
+public:
+    void set_value(T value) {
+        value_ = std::move(value);
+        complete();
+    }
+
+    const T& value() const {
+        wait();
+        rethrow_if_failed();
+        return *value_;
+    }
+
+    T take_value() {
+        wait();
+        rethrow_if_failed();
+        return std::move(*value_);
+    }
+
+private:
+    optional<T> value_;
+};
+
+template<>
+class TaskState<void> : public TaskStateBase {
+public:
+    void set_value() { complete(); }
+
+    void value() const {
+        wait();
+        rethrow_if_failed();
+    }
+
+    void take_value() { value(); }
+};
+
+template<typename T>
+struct TaskPromiseBase {
+    std::shared_ptr<TaskState<T>> state = std::make_shared<TaskState<T>>();
+
+    void return_value(T value) { state->set_value(std::move(value)); }
+};
+
+template<>
+struct TaskPromiseBase<void> {
+    std::shared_ptr<TaskState<void>> state = std::make_shared<TaskState<void>>();
+
+    void return_void() { state->set_value(); }
+};
+
+/// Suspends a coroutine until the task state has completed.
+class TaskStateAwaiter {
+public:
+    explicit TaskStateAwaiter(std::shared_ptr<TaskStateBase> state)
+        : state_(std::move(state)) {}
+
+    bool await_ready() const { return state_->ready(); }
+
+    bool await_suspend(std::coroutine_handle<> continuation) { return state_->add_continuation(continuation); }
+
+protected:
+    std::shared_ptr<TaskStateBase> state_;
+};
+
+}
+
+/// A handle of a task that can be waited for without knowing the type of its value.
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    explicit TaskHandle(std::shared_ptr<detail::TaskStateBase> state)
+        : state_(std::move(state)) {}
+
+    inline bool ready() const { return !state_ || state_->ready(); }
+
+    void wait() const {
+        if (state_) state_->wait();
+    }
+
+    /// Resumes the awaiting coroutine when the task has completed, whether it has failed or not.
+    auto operator co_await() const {
+        struct Awaiter : detail::TaskStateAwaiter {
+            using detail::TaskStateAwaiter::TaskStateAwaiter;
+
+            void await_resume() const {}
+        };
+        return Awaiter(state_ ? state_ : completed_state());
+    }
+
+private:
+    std::shared_ptr<detail::TaskStateBase> state_;
+
+    static std::shared_ptr<detail::TaskStateBase> completed_state() {
+        auto state = std::make_shared<detail::TaskState<void>>();
+        state->set_value();
+        return state;
+    }
+};
+
+/// The result of a coroutine that starts running as soon as it is called, like `std::future` for coroutines.
+///
+/// A task can be awaited by other coroutines, which resume on the thread that completes the task,
+/// or waited for with `get`, which blocks the calling thread. Copies of a task share its state.
+template<typename T>
+class Task {
+public:
+    struct promise_type : detail::TaskPromiseBase<T> {
+        Task get_return_object() { return Task(this->state); }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { this->state->set_exception(std::current_exception()); }
+    };
+
+    inline bool ready() const { return state_->ready(); }
+
+    /// Blocks until the task has completed and returns its value, or rethrows the exception it has failed with.
+    decltype(auto) get() const& { return state_->value(); }
+
+    T get() && { return state_->take_value(); }
+
+    inline TaskHandle handle() const { return TaskHandle(state_); }
+
+    auto operator co_await() const& {
+        struct Awaiter : detail::TaskStateAwaiter {
+            using detail::TaskStateAwaiter::TaskStateAwaiter;
+
+            T await_resume() const { return static_cast<const detail::TaskState<T>&>(*state_).value(); }
+        };
+        return Awaiter(state_);
+    }
+
+    auto operator co_await() && {
+        struct Awaiter : detail::TaskStateAwaiter {
+            using detail::TaskStateAwaiter::TaskStateAwaiter;
+
+            T await_resume() const { return static_cast<detail::TaskState<T>&>(*state_).take_value(); }
+        };
+        return Awaiter(std::move(state_));
+    }
+
+private:
+    std::shared_ptr<detail::TaskState<T>> state_;
+
+    explicit Task(std::shared_ptr<detail::TaskState<T>> state)
+        : state_(std::move(state)) {}
+};
+
+/// Completes when all of the tasks have completed.
+inline Task<void> when_all(std::vector<TaskHandle> tasks) {
+    for (const TaskHandle& task: tasks) {
+        co_await task;
+    }
+}
+
+namespace detail {
+
+/// Whether `resume_on` keeps running the coroutines started on the current thread, see `InlineResumption`.
+inline thread_local bool resumes_inline = false;
+
+/// Makes `resume_on` keep running the coroutines started on the current thread during the lifetime of the scope.
+///
+/// A thread that blocks until a task completes gains nothing from moving its work to an executor. If the thread
+/// is a worker of that executor, e.g. of a `WorkStealingPool` with a single worker, it may even wait
+/// for a task that no worker is left to run.
+class InlineResumption {
+public:
+    InlineResumption()
+        : previous_(resumes_inline) {
+        resumes_inline = true;
+    }
+
+    InlineResumption(const InlineResumption&) = delete;
+
+    InlineResumption& operator =(const InlineResumption&) = delete;
+
+    ~InlineResumption() { resumes_inline = previous_; }
+
+private:
+    bool previous_;
+};
+
+}
+
+/// Moves the awaiting coroutine to a task of the executor, or keeps running it if there is no executor.
+///
+/// An asynchronous measurable awaits this before its expensive work, so the layout can go on
+/// with the other elements in the meantime. A coroutine that is waited for right away keeps running
+/// on its thread, see `detail::InlineResumption`.
+inline auto resume_on(Executor* executor) {
+    struct Awaiter {
+        Executor* executor;
+
+        bool await_ready() const { return executor == nullptr || detail::resumes_inline; }
+
+        void await_suspend(std::coroutine_handle<> continuation) const {
+            executor->execute([continuation] { continuation.resume(); });
+        }
+
+        void await_resume() const {}
+    };
+    return Awaiter{ executor };
+}
+
+}
+
+#endif //VPACKCORE_TASK_HPP
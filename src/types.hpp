@@ -13,13 +13,21 @@
 namespace vpk::core::detail {
 
 template<typename T>
-T almost_equal(T x, T y) {
-    const auto abs = std::abs(x - y);
-    // The machine epsilon has to be scaled to the magnitude of the values used
-    // and multiplied by the desired precision in ULPs (units in the last place)
-    return abs <= std::numeric_limits<T>::epsilon() * std::abs(x + y)
-           // unless the result is subnormal
-           || abs < std::numeric_limits<T>::min();
+bool almost_equal(T x, T y) {
+    // Equal infinities have no finite difference, and a finite value is never close to an infinity.
+    if (x == y) return true;
+    if constexpr (std::numeric_limits<T>::is_exact) {
+        // Exact types, e.g. `FixedPoint`, are only equal to themselves.
+        return false;
+    } else {
+        const auto abs = std::abs(x - y);
+        if (abs == std::numeric_limits<T>::infinity()) return false;
+        // The machine epsilon has to be scaled to the magnitude of the values used
+        // and multiplied by the desired precision in ULPs (units in the last place)
+        return abs <= std::numeric_limits<T>::epsilon() * std::abs(x + y)
+               // unless the result is subnormal
+               || abs < std::numeric_limits<T>::min();
+    }
 }
 
 }
@@ -424,4 +432,49 @@ public:
 
 }
 
+//////////////////////////////// Range ////////////////////////////////
+
+namespace vpk::core {
+
+/// A half-open range of values `[lower, upper)`.
+///
+/// A degenerate range whose bounds are equal contains only its bound, so it can describe a single value.
+template<typename ValueType>
+struct Range {
+    ValueType lower;
+    ValueType upper;
+
+    /// The range that only contains the specified value.
+    static constexpr Range exactly(ValueType value) { return { value, value }; }
+
+    static constexpr Range unbounded() {
+        return { -std::numeric_limits<ValueType>::infinity(), std::numeric_limits<ValueType>::infinity() };
+    }
+
+    /// The range that contains no value.
+    static constexpr Range none() {
+        return { std::numeric_limits<ValueType>::infinity(), -std::numeric_limits<ValueType>::infinity() };
+    }
+
+    constexpr bool empty() const { return upper < lower; }
+
+    constexpr bool contains(ValueType value) const {
+        return !empty() && (value == lower || (lower < value && value < upper));
+    }
+
+    /// The values contained by both ranges.
+    constexpr Range intersection(const Range& other) const {
+        const Range range{ std::max(lower, other.lower), std::min(upper, other.upper) };
+        // Two half-open ranges that only touch share no value, unless one of them is degenerate.
+        if (range.lower == range.upper && !(contains(range.lower) && other.contains(range.lower))) return none();
+        return range;
+    }
+
+    constexpr bool operator ==(const Range& other) const { return lower == other.lower && upper == other.upper; }
+
+    constexpr bool operator !=(const Range& other) const { return !(*this == other); }
+};
+
+}
+
 #endif //VPACKCORE_TYPES_HPP
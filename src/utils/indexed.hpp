@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <utility>
+#include <iterator>
 #include <type_traits>
 
 namespace vpk {
@@ -30,7 +31,7 @@ struct Indexed {
     template<typename Iter, typename SizeType>
     struct IndexedIterator {
         using Type = IndexedIterator<Iter, SizeType>;
-        using ReferenceType = typename Iter::reference;
+        using ReferenceType = typename std::iterator_traits<Iter>::reference;
 
         Type& operator ++() {
             ++this->it_;
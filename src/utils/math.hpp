@@ -11,13 +11,9 @@
 
 namespace vpk {
 
-template<typename T, typename = std::enable_if<std::numeric_limits<T>::has_infinity>>
-static bool is_infinity(const T& n) {
-    return n == std::numeric_limits<T>::infinity();
-}
-
-template<typename T, typename = std::enable_if<std::numeric_limits<T>::has_infinity>>
-static bool is_infinity(T&& n) {
+/// Whether the value is positive infinity.
+template<typename T, typename = std::enable_if_t<std::numeric_limits<T>::has_infinity>>
+inline bool is_infinity(const T& n) {
     return n == std::numeric_limits<T>::infinity();
 }
 
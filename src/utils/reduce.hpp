@@ -0,0 +1,117 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_REDUCE_HPP
+#define VPACKCORE_REDUCE_HPP
+
+#include <span>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace vpk {
+
+namespace detail {
+
+#if defined(__AVX2__)
+
+inline float horizontal_sum(__m256 values) {
+    const __m128 half = _mm_add_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+    const __m128 quarter = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_add_ss(quarter, _mm_shuffle_ps(quarter, quarter, 1)));
+}
+
+inline double horizontal_sum(__m256d values) {
+    const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+inline float horizontal_max(__m256 values) {
+    const __m128 half = _mm_max_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+    const __m128 quarter = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_max_ss(quarter, _mm_shuffle_ps(quarter, quarter, 1)));
+}
+
+inline double horizontal_max(__m256d values) {
+    const __m128d half = _mm_max_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+#endif
+
+}
+
+/// The sum of the values.
+///
+/// With AVX2 enabled (e.g. `-mavx2`), a list of `float`s or `double`s is added in 8 or 4 lanes, so the order
+/// of the additions and thereby the rounding differ from a sequential sum. Other types are added sequentially.
+template<typename T>
+T reduce_sum(std::type_identity_t<std::span<const T>> values) {
+    std::size_t i = 0;
+    T sum = 0;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, float>) {
+        if (values.size() >= 8) {
+            __m256 lanes = _mm256_setzero_ps();
+            for (; i + 8 <= values.size(); i += 8) {
+                lanes = _mm256_add_ps(lanes, _mm256_loadu_ps(values.data() + i));
+            }
+            sum = detail::horizontal_sum(lanes);
+        }
+    } else if constexpr (std::is_same_v<T, double>) {
+        if (values.size() >= 4) {
+            __m256d lanes = _mm256_setzero_pd();
+            for (; i + 4 <= values.size(); i += 4) {
+                lanes = _mm256_add_pd(lanes, _mm256_loadu_pd(values.data() + i));
+            }
+            sum = detail::horizontal_sum(lanes);
+        }
+    }
+#endif
+    for (; i < values.size(); ++i) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+/// The largest of the values and the initial value.
+///
+/// Vectorized like `reduce_sum`, the result does not depend on the order.
+template<typename T>
+T reduce_max(std::type_identity_t<std::span<const T>> values, T initial) {
+    std::size_t i = 0;
+    T result = initial;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, float>) {
+        if (values.size() >= 8) {
+            __m256 lanes = _mm256_set1_ps(initial);
+            for (; i + 8 <= values.size(); i += 8) {
+                lanes = _mm256_max_ps(lanes, _mm256_loadu_ps(values.data() + i));
+            }
+            result = detail::horizontal_max(lanes);
+        }
+    } else if constexpr (std::is_same_v<T, double>) {
+        if (values.size() >= 4) {
+            __m256d lanes = _mm256_set1_pd(initial);
+            for (; i + 4 <= values.size(); i += 4) {
+                lanes = _mm256_max_pd(lanes, _mm256_loadu_pd(values.data() + i));
+            }
+            result = detail::horizontal_max(lanes);
+        }
+    }
+#endif
+    for (; i < values.size(); ++i) {
+        result = std::max(result, values[i]);
+    }
+    return result;
+}
+
+}
+
+#endif //VPACKCORE_REDUCE_HPP
@@ -0,0 +1,225 @@
+//
+// Created by ktiays on 2022/9/17.
+// Copyright (c) 2022 ktiays. All rights reserved.
+//
+
+#ifndef VPACKCORE_SMALL_VECTOR_HPP
+#define VPACKCORE_SMALL_VECTOR_HPP
+
+#include <new>
+#include <memory>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+namespace vpk {
+
+/// A vector that stores up to `InlineCapacity` elements inside itself and only allocates when it grows beyond,
+/// for the many small arrays of a layout tree.
+///
+/// The interface is the subset of `std::vector` the layout needs. Unlike a `std::vector`, moving a small vector
+/// moves its inline elements one by one.
+template<typename T, std::size_t InlineCapacity>
+class SmallVector {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept = default;
+
+    explicit SmallVector(size_type count) { resize(count); }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    SmallVector(InputIt first, InputIt last) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>) {
+            reserve(static_cast<size_type>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    SmallVector(std::initializer_list<T> list)
+        : SmallVector(list.begin(), list.end()) {}
+
+    SmallVector(const SmallVector& other)
+        : SmallVector(other.begin(), other.end()) {}
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        take(std::move(other));
+    }
+
+    SmallVector& operator =(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), data_);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator =(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            deallocate();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        deallocate();
+    }
+
+    inline size_type size() const noexcept { return size_; }
+
+    inline bool empty() const noexcept { return size_ == 0; }
+
+    inline size_type capacity() const noexcept { return capacity_; }
+
+    /// Whether the elements are stored inside the vector, i.e. the vector has not allocated.
+    inline bool is_inline() const noexcept { return data_ == inline_data(); }
+
+    inline T* data() noexcept { return data_; }
+
+    inline const T* data() const noexcept { return data_; }
+
+    inline iterator begin() noexcept { return data_; }
+
+    inline const_iterator begin() const noexcept { return data_; }
+
+    inline iterator end() noexcept { return data_ + size_; }
+
+    inline const_iterator end() const noexcept { return data_ + size_; }
+
+    inline T& operator [](size_type index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    inline const T& operator [](size_type index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    T& at(size_type index) {
+        if (index >= size_) throw std::out_of_range("SmallVector::at");
+        return data_[index];
+    }
+
+    const T& at(size_type index) const {
+        if (index >= size_) throw std::out_of_range("SmallVector::at");
+        return data_[index];
+    }
+
+    inline T& front() noexcept { return (*this)[0]; }
+
+    inline const T& front() const noexcept { return (*this)[0]; }
+
+    inline T& back() noexcept { return (*this)[size_ - 1]; }
+
+    inline const T& back() const noexcept { return (*this)[size_ - 1]; }
+
+    void reserve(size_type capacity) {
+        if (capacity <= capacity_) return;
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(alignof(T))));
+        std::uninitialized_move(begin(), end(), data);
+        std::destroy(begin(), end());
+        deallocate();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&& ... args) {
+        if (size_ == capacity_) {
+            // The arguments may refer to elements of the vector, create the element before they move.
+            T value(std::forward<Args>(args)...);
+            reserve(std::max<size_type>(capacity_ * 2, 1));
+            return append(std::move(value));
+        }
+        return append(std::forward<Args>(args)...);
+    }
+
+    inline void push_back(const T& value) { emplace_back(value); }
+
+    inline void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept {
+        assert(size_ > 0);
+        size_ -= 1;
+        std::destroy_at(data_ + size_);
+    }
+
+    /// Resizes the vector, new elements are value-initialized.
+    void resize(size_type count) {
+        if (count < size_) {
+            std::destroy(begin() + count, end());
+        } else if (count > size_) {
+            reserve(count);
+            std::uninitialized_value_construct(end(), begin() + count);
+        }
+        size_ = count;
+    }
+
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        size_ = 0;
+    }
+
+private:
+    T* data_ = inline_data();
+    size_type size_ = 0;
+    size_type capacity_ = InlineCapacity;
+    alignas(T) std::byte storage_[InlineCapacity == 0 ? 1 : InlineCapacity * sizeof(T)];
+
+    inline T* inline_data() noexcept { return reinterpret_cast<T*>(storage_); }
+
+    inline const T* inline_data() const noexcept { return reinterpret_cast<const T*>(storage_); }
+
+    template<typename... Args>
+    inline T& append(Args&& ... args) {
+        T* element = std::construct_at(data_ + size_, std::forward<Args>(args)...);
+        size_ += 1;
+        return *element;
+    }
+
+    /// Frees the allocated storage of an empty vector and returns to the inline storage.
+    void deallocate() noexcept {
+        if (!is_inline()) ::operator delete(data_, std::align_val_t(alignof(T)));
+        data_ = inline_data();
+        capacity_ = InlineCapacity;
+    }
+
+    /// Takes the elements of the other vector and leaves it empty, the vector itself must be empty and inline.
+    void take(SmallVector&& other) {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.begin(), other.end(), data_);
+            size_ = other.size_;
+            other.clear();
+        } else {
+            data_ = std::exchange(other.data_, other.inline_data());
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, InlineCapacity);
+        }
+    }
+};
+
+}
+
+#endif //VPACKCORE_SMALL_VECTOR_HPP
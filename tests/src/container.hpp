@@ -29,7 +29,7 @@ public:
     __IMPL_LAYOUT_PARAMS_FOR_CONTAINER(VStack)
 
     T make_view() const override {
-        return std::make_shared<vpk::core::VerticalContainer<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::VerticalContainer<identifier_t, value_type>>(
             items_, vpk::core::LayoutParams<double>{
                 size_property, padding_, offset_
             }, alignment_
@@ -62,7 +62,7 @@ public:
     __IMPL_LAYOUT_PARAMS_FOR_CONTAINER(HStack)
 
     T make_view() const override {
-        return std::make_shared<vpk::core::HorizontalContainer<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::HorizontalContainer<identifier_t, value_type>>(
             items_, vpk::core::LayoutParams<double>{
                 size_property, padding_, offset_
             }, alignment_
@@ -95,7 +95,7 @@ public:
     __IMPL_LAYOUT_PARAMS_FOR_CONTAINER(ZStack)
 
     T make_view() const override {
-        return std::make_shared<vpk::core::StackContainer<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::StackContainer<identifier_t, value_type>>(
             items_, vpk::core::LayoutParams<double>{}, alignment_
         );
     }
@@ -116,12 +116,12 @@ template<typename T = decltype(std::declval<SomeView>().make_view())>
 class DStack : public SomeView {
 public:
     DStack(std::vector<T>&& v, vpk::core::DecoratedStyle style)
-        : items_(v), style_(style) {}
+        : items_(std::move(v)), style_(style) {}
 
     __IMPL_LAYOUT_PARAMS_FOR_CONTAINER(DStack)
 
     T make_view() const override {
-        return std::make_shared<vpk::core::DecoratedContainer<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::DecoratedContainer<identifier_t, value_type>>(
             items_, vpk::core::LayoutParams<double>{}, style_
         );
     }
@@ -7,9 +7,8 @@
 #define VPACKCORE_SOME_VIEW_HPP
 
 #include <string>
-#include <random>
+#include <memory>
 
-#include "uuid.h"
 #include "../../VpackCore.hpp"
 
 #define __IMPL_PADDING_FOR_CONTAINER(container) \
@@ -47,16 +46,6 @@ namespace vpkt {
 
 const double infinity = std::numeric_limits<double>::infinity();
 
-static std::string spacer_identifier_prefix() {
-    return "__spacer";
-}
-
-static std::string uuid() {
-    std::random_device rd;
-    std::mt19937 gen{ rd() };
-    return uuids::to_string(uuids::uuid_random_generator{ gen }());
-}
-
 struct SomeView {
     using identifier_t = std::string;
     using value_type = double;
@@ -65,17 +54,22 @@ struct SomeView {
 
     vpk::core::LayoutResult<identifier_t, value_type> compute(vpk::core::Rect<value_type>&& frame) const {
         const auto computer = vpk::core::LayoutComputer<identifier_t, value_type>(make_view());
-        auto result = computer.compute(frame);
-        auto& map = result.map;
-        for (auto iter = result.map.begin(); iter != result.map.end();) {
-            if (iter->first.find(spacer_identifier_prefix()) != std::string::npos) {
-                iter = result.map.erase(iter);
-            } else { ++iter; }
-        }
-        return result;
+        return computer.compute(frame);
     };
 };
 
+/// Creates the element of the view with another measurable, e.g. to compare a custom measurable
+/// with the measurable of a `Text`.
+///
+/// The element keeps the identifier and the parameters of the view, the view must create an item.
+inline vpk::core::LayoutablePointer<SomeView::identifier_t, SomeView::value_type>
+with_measurable(const SomeView& view, std::shared_ptr<vpk::core::Measurable<SomeView::value_type>> measurable) {
+    using Item = vpk::core::Item<SomeView::identifier_t, SomeView::value_type>;
+    const auto element = view.make_view();
+    const Item& item = static_cast<const Item&>(*element);
+    return vpk::core::make_layoutable<Item>(item.identifier(), item.params(), std::move(measurable));
+}
+
 }
 
 #endif //VPACKCORE_SOME_VIEW_HPP
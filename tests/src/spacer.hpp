@@ -21,8 +21,7 @@ struct Spacer : public SomeView {
             layout_params(),
             {},
             {}, -1 };
-        return std::make_shared<vpk::core::Item<identifier_t, value_type>>(
-            spacer_identifier_prefix() + uuid(),
+        return vpk::core::make_layoutable<vpk::core::Item<identifier_t, value_type>>(
             params,
             std::make_shared<vpk::core::AnyMeasurable<value_type>>()
         );
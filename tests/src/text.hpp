@@ -12,6 +12,52 @@
 
 namespace vpkt {
 
+/// Measures a text of monospaced characters that breaks into lines at any character.
+class TextMeasurable : public vpk::core::Measurable<SomeView::value_type> {
+public:
+    using value_type = SomeView::value_type;
+
+    static constexpr vpk::core::Size<value_type> character_size() {
+        return { 5, 8 };
+    }
+
+    explicit TextMeasurable(int length)
+        : text_length_(length) {}
+
+    vpk::core::Size<value_type> measure(const vpk::core::Size<value_type>& size) const override {
+        return measure_with_validity(size).size;
+    }
+
+    vpk::core::Measurement<value_type> measure_with_validity(const vpk::core::Size<value_type>& size) const override {
+        using Range = vpk::core::Range<value_type>;
+        const value_type character_width = character_size().width;
+        const int number_of_char_in_line =
+            std::max(1, static_cast<int>(size.width) / static_cast<int>(character_width));
+        // The lines only change when a character more or less fits into a line, the height is not constrained.
+        if (number_of_char_in_line >= text_length_) {
+            return {
+                { text_length_ * character_width, character_size().height },
+                text_length_ <= 1 ? Range::unbounded()
+                                  : Range{ text_length_ * character_width, std::numeric_limits<value_type>::infinity() },
+                Range::unbounded()
+            };
+        }
+        return {
+            {
+                number_of_char_in_line * character_width,
+                ceil(text_length_ / static_cast<value_type>(number_of_char_in_line)) * character_size().height
+            },
+            number_of_char_in_line == 1
+            ? Range{ -std::numeric_limits<value_type>::infinity(), 2 * character_width }
+            : Range{ number_of_char_in_line * character_width, (number_of_char_in_line + 1) * character_width },
+            Range::unbounded()
+        };
+    }
+
+private:
+    int text_length_;
+};
+
 class Text : public SomeView {
 public:
     Text(identifier_t&& identifier, int length)
@@ -22,7 +68,7 @@ public:
     __IMPL_OFFSET_FOR_CONTAINER(Text)
 
     static constexpr vpk::core::Size<value_type> character_size() {
-        return { 5, 8 };
+        return TextMeasurable::character_size();
     }
 
     vpk::core::LayoutablePointer<identifier_t, value_type> make_view() const override {
@@ -30,21 +76,8 @@ public:
             { character_size().width, character_size().height,
               character_size().width * text_length_, character_size().height * text_length_ },
             padding_, offset_ };
-        return std::make_shared<vpk::core::Item<identifier_t, value_type>>(
-            identifier_,
-            params,
-            std::make_shared<vpk::core::AnyMeasurable<value_type>>(
-                [this](const vpk::core::Size<value_type>& size) -> vpk::core::Size<value_type> {
-                    const int number_of_char_in_line =
-                        std::max(1, static_cast<int>(size.width) / static_cast<int>(character_size().width));
-                    if (number_of_char_in_line >= this->text_length_)
-                        return { this->text_length_ * character_size().width, character_size().height };
-                    return {
-                        number_of_char_in_line * character_size().width,
-                        ceil(this->text_length_ / static_cast<value_type>(number_of_char_in_line)) *
-                        character_size().height
-                    };
-                })
+        return vpk::core::make_layoutable<vpk::core::Item<identifier_t, value_type>>(
+            identifier_, params, std::make_shared<TextMeasurable>(text_length_)
         );
     }
 
@@ -22,7 +22,7 @@ public:
 
     vpk::core::LayoutablePointer<identifier_t, value_type> make_view() const override {
         const vpk::core::LayoutParams<value_type> params{ size_property, padding_, offset_ };
-        return std::make_shared<vpk::core::Item<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::Item<identifier_t, value_type>>(
             identifier_,
             params,
             std::make_shared<vpk::core::AnyMeasurable<value_type>>(size_)
@@ -45,7 +45,7 @@ public:
 
     vpk::core::LayoutablePointer<identifier_t, value_type> make_view() const override {
         const vpk::core::LayoutParams<value_type> params{ size_property, padding_, offset_ };
-        return std::make_shared<vpk::core::Item<identifier_t, value_type>>(
+        return vpk::core::make_layoutable<vpk::core::Item<identifier_t, value_type>>(
             identifier_,
             params,
             std::make_shared<vpk::core::AnyMeasurable<value_type>>()
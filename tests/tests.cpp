@@ -3,7 +3,9 @@
 // Copyright (c) 2022 ktiays. All rights reserved.
 //
 
+#include <numeric>
 #include <algorithm>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -11,6 +13,7 @@
 #include "src/text.hpp"
 #include "src/spacer.hpp"
 #include "src/container.hpp"
+#include "../src/utils/math.hpp"
 
 using Identifier = vpkt::SomeView::identifier_t;
 using ValueType = vpkt::SomeView::value_type;
@@ -117,6 +120,38 @@ TEST(VpackCoreTest, VerticalContainer) {
     ASSERT_EQ(result, answer);
 }
 
+TEST(VpackCoreTest, LayoutPriority) {
+    using namespace vpkt;
+    using Item = vpk::core::Item<Identifier, ValueType>;
+
+    const auto make_text = [](std::string id, int priority) -> vpk::core::LayoutablePointer<Identifier, ValueType> {
+        auto params = Text(std::string(id), 10).make_view()->params();
+        params.priority = priority;
+        return vpk::core::make_layoutable<Item>(std::move(id), params, std::make_shared<TextMeasurable>(10));
+    };
+    // The elements of higher priority take their space first, the others share the rest.
+    const auto result = HStack{
+        {
+            make_text("A", 0),
+            make_text("B", 2),
+            make_text("C", -1),
+            make_text("D", 2),
+        }
+    }.compute({ 0, 0, 130, 100 });
+
+    // C only gets its minimum width after the others, so the content overflows and is centered.
+    const LayoutResult answer{
+        {
+            { "A", {{ -2.5, 42, 30, 16 }, 0 }},
+            { "B", {{ 27.5, 46, 50, 8 }, 0 }},
+            { "C", {{ 77.5, 10, 5, 80 }, 0 }},
+            { "D", {{ 82.5, 46, 50, 8 }, 0 }},
+        }, 0
+    };
+
+    ASSERT_EQ(result, answer);
+}
+
 TEST(VpackCoreTest, StackContainer) {
     const auto result = vpkt::ZStack{
         {
@@ -223,4 +258,1110 @@ TEST(VpackCoreTest, Compose) {
     };
 
     ASSERT_EQ(result, answer);
-}
\ No newline at end of file
+}
+
+TEST(VpackCoreTest, CompactSizeProperty) {
+    using vpk::core::CompactOptional;
+    using SizeProperty = vpk::core::SizeProperty<ValueType>;
+
+    static_assert(sizeof(CompactOptional<ValueType>) == sizeof(ValueType));
+    static_assert(sizeof(SizeProperty) == 4 * sizeof(ValueType));
+    static_assert(sizeof(vpk::core::LayoutParams<ValueType>) <= 11 * sizeof(ValueType));
+
+    const SizeProperty size_property{ 0, {}, vpkt::infinity, 20 };
+    ASSERT_TRUE(size_property.min_width.has_value());
+    ASSERT_EQ(*size_property.min_width, 0);
+    ASSERT_FALSE(size_property.min_height.has_value());
+    ASSERT_EQ(size_property.min_height.value_or(5), 5);
+    ASSERT_EQ(*size_property.max_width, vpkt::infinity);
+
+    CompactOptional<ValueType> value = vpk::optional<ValueType>(3);
+    ASSERT_EQ(*value, 3);
+    value = vpk::nullopt;
+    ASSERT_FALSE(value);
+    ASSERT_EQ(value, CompactOptional<ValueType>());
+    ASSERT_FALSE(static_cast<vpk::optional<ValueType>>(value).has_value());
+
+    CompactOptional<int> integer;
+    ASSERT_FALSE(integer.has_value());
+    integer = -1;
+    ASSERT_EQ(*integer, -1);
+}
+
+TEST(VpackCoreTest, IntrinsicSize) {
+    using namespace vpkt;
+
+    const auto b = View("B", { 10, 60 }).make_view();
+    const auto stack = HStack{
+        {
+            View("A", { 20, 30 }).padding({ 5, 5, 5, 5 }).make_view(),
+            b,
+            VStack{{ View("C", { 40, 10 }).make_view(), View("D", { 40, 10 }).make_view() }}.make_view(),
+        }
+    }.make_view();
+
+    ASSERT_EQ(stack->min_width(), 80);
+    ASSERT_EQ(stack->max_width(), 80);
+    ASSERT_EQ(stack->min_height(), 60);
+    ASSERT_EQ(stack->max_height(), 60);
+
+    // The sizes are kept until the changes are discarded, which the layouts do before they measure the tree.
+    vpk::core::SizeProperty<ValueType> size_property = b->params().size_property;
+    size_property.max_height = 100;
+    b->set_size_property(size_property);
+    ASSERT_EQ(stack->max_height(), 60);
+    ASSERT_TRUE(stack->discard_changed_sizes());
+    ASSERT_EQ(stack->min_height(), 60);
+    ASSERT_EQ(stack->max_height(), 100);
+    ASSERT_FALSE(stack->discard_changed_sizes());
+
+    // The measurements calculated with the old sizes are discarded as well, even if the context retains them.
+    const auto a = InfView("A").max_width(50).make_view();
+    const auto root = ZStack{{ VStack{{ a }}.make_view(), InfView("B").max_width(1e9).make_view() }}.make_view();
+    const vpk::core::LayoutComputer<Identifier, ValueType> computer(root);
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 100, 100 };
+    vpk::core::LayoutContext context;
+    context.set_retains_measurements(true);
+    vpk::core::LayoutContext::Scope scope(context);
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 50);
+    size_property = a->params().size_property;
+    size_property.max_width = 20;
+    a->set_size_property(size_property);
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 20);
+    ASSERT_EQ(computer.compute(frame).map.at("B").frame.width, 100);
+    a->set_padding({ 40, 0, 40, 0 });
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 20);
+
+    // An element that outlives its container no longer passes its changes to it.
+    const auto c = View("C", { 10, 10 }).make_view();
+    {
+        const auto row = HStack{{ c }}.make_view();
+        ASSERT_EQ(row->min_width(), 10);
+    }
+    c->set_padding({ 5, 0, 5, 0 });
+    ASSERT_TRUE(c->discard_changed_sizes());
+}
+
+TEST(VpackCoreTest, ContainerBuilder) {
+    using namespace vpk::core;
+    using Item = Item<Identifier, ValueType>;
+
+    const LayoutParams<ValueType> params = vpkt::View("A", { 20, 20 }).make_view()->params();
+    auto decoration = vpkt::View("B", { 10, 60 }).make_view();
+    const auto stack = ContainerBuilder<Identifier, ValueType>(2)
+        .emplace<Item>("A", params, std::make_shared<AnyMeasurable<ValueType>>(Size<ValueType>{ 20, 20 }))
+        .add(std::move(decoration))
+        .build<DecoratedContainer<Identifier, ValueType>>(LayoutParams<ValueType>{}, DecoratedStyle::background);
+
+    // The container holds the only references to the elements.
+    for (const auto& child: stack->child_elements()) {
+        ASSERT_EQ(child.use_count(), 1);
+    }
+
+    const auto result = LayoutComputer<Identifier, ValueType>(stack).compute({ 0, 0, 100, 100 });
+    const auto answer = vpkt::DStack{
+        { vpkt::View("A", { 20, 20 }).make_view(), vpkt::View("B", { 10, 60 }).make_view() },
+        DecoratedStyle::background
+    }.compute({ 0, 0, 100, 100 });
+    ASSERT_EQ(result, answer);
+}
+
+TEST(VpackCoreTest, IntrusivePointer) {
+    using namespace vpk::core;
+
+    struct Node : public ReferenceCounted {
+        explicit Node(int& destructions) : destructions(destructions) {}
+
+        virtual ~Node() { destructions += 1; }
+
+        int& destructions;
+    };
+    struct Leaf : public Node {
+        using Node::Node;
+    };
+
+    int destructions = 0;
+    IntrusivePointer<Leaf> leaf = make_intrusive<Leaf>(destructions);
+    IntrusivePointer<Node> node = leaf;
+    ASSERT_EQ(node.use_count(), 2);
+    ASSERT_EQ(node.get(), leaf.get());
+
+    IntrusivePointer<Node> moved = std::move(node);
+    ASSERT_FALSE(node);
+    ASSERT_EQ(moved.use_count(), 2);
+
+    leaf.reset();
+    ASSERT_EQ(moved.use_count(), 1);
+    ASSERT_EQ(destructions, 0);
+    moved = nullptr;
+    ASSERT_EQ(destructions, 1);
+
+    // A handoff pointer deletes the object if it is destroyed after the last intrusive pointer, on any thread.
+    IntrusivePointer<Node> owner = make_intrusive<Node>(destructions);
+    HandoffPointer<Node> handoff(owner);
+    owner.reset();
+    ASSERT_EQ(destructions, 1);
+    std::thread([handoff = std::move(handoff)]() mutable { handoff.reset(); }).join();
+    ASSERT_EQ(destructions, 2);
+
+    // Otherwise the last intrusive pointer does.
+    owner = make_intrusive<Node>(destructions);
+    HandoffPointer<Node>(owner).reset();
+    ASSERT_EQ(owner.use_count(), 1);
+    owner.reset();
+    ASSERT_EQ(destructions, 3);
+}
+
+TEST(VpackCoreTest, SmallVector) {
+    using Vector = vpk::SmallVector<std::shared_ptr<int>, 2>;
+
+    Vector small;
+    small.push_back(std::make_shared<int>(0));
+    small.emplace_back(std::make_shared<int>(1));
+    ASSERT_TRUE(small.is_inline());
+
+    // Growing beyond the inline capacity moves the elements to the heap.
+    Vector large = small;
+    large.push_back(large.front());
+    ASSERT_FALSE(large.is_inline());
+    ASSERT_EQ(large.size(), 3);
+    ASSERT_EQ(*large[1], 1);
+    ASSERT_EQ(large[2], small[0]);
+    ASSERT_EQ(small[0].use_count(), 3);
+
+    Vector moved = std::move(large);
+    ASSERT_TRUE(large.empty());
+    ASSERT_EQ(moved.size(), 3);
+    moved = std::move(small);
+    ASSERT_TRUE(moved.is_inline());
+    ASSERT_EQ(moved[0].use_count(), 1);
+
+    moved.resize(1);
+    ASSERT_EQ(moved.size(), 1);
+    ASSERT_EQ(*moved.back(), 0);
+}
+
+TEST(VpackCoreTest, InternedIdentifier) {
+    using namespace vpk::core;
+    using Handle = InternedIdentifier;
+
+    IdentifierInterner<std::string> interner;
+    const Handle a = interner.intern("A");
+    const Handle b = interner.intern("B");
+    ASSERT_EQ(interner.intern("A"), a);
+    ASSERT_NE(a, b);
+    ASSERT_EQ(interner.resolve(b), "B");
+    ASSERT_FALSE(interner.find("C").has_value());
+
+    const auto fixed_size = [](ValueType width, ValueType height) {
+        return LayoutParams<ValueType>{ { width, height, width, height }, {}, {}};
+    };
+    const auto root = make_layoutable<HorizontalContainer<Handle, ValueType>>(
+        std::vector<LayoutablePointer<Handle, ValueType>>{
+            make_layoutable<Item<Handle, ValueType>>(
+                a, fixed_size(20, 20), std::make_shared<AnyMeasurable<ValueType>>(Size<ValueType>{ 20, 20 })
+            ),
+            make_layoutable<Item<Handle, ValueType>>(
+                LayoutParams<ValueType>{{ 0, 0, vpkt::infinity, vpkt::infinity }, {}, {}, -1 },
+                std::make_shared<AnyMeasurable<ValueType>>()
+            ),
+            make_layoutable<Item<Handle, ValueType>>(
+                b, fixed_size(10, 60), std::make_shared<AnyMeasurable<ValueType>>(Size<ValueType>{ 10, 60 })
+            ),
+        }, LayoutParams<ValueType>{}, VerticalAlignment::center
+    );
+    const auto result = LayoutComputer<Handle, ValueType>(root).compute({ 0, 0, 100, 100 });
+
+    const vpk::core::LayoutResult<Handle, ValueType> answer{
+        {
+            { a, {{ 0, 40, 20, 20 }, 0 }},
+            { b, {{ 90, 20, 10, 60 }, 0 }},
+        }, 0
+    };
+
+    ASSERT_EQ(result, answer);
+}
+
+TEST(VpackCoreTest, IncrementalLayout) {
+    using namespace vpkt;
+    const auto make_tree = [] {
+        return VStack{
+            {
+                HStack(
+                    {
+                        View("Image", { 30, 30 }).make_view(),
+                        VStack{
+                            {
+                                Text("Title", 8).make_view(),
+                                Text("Account ID", 12).make_view(),
+                            }
+                        }.make_view(),
+                        HSpacer().make_view(),
+                    }
+                ).make_view(),
+                ZStack{
+                    {
+                        View("A", { 20, 20 }).make_view(),
+                        Text("B", 9).make_view(),
+                    }
+                }.make_view(),
+            }
+        }.padding({ 12, 0, 12, 0 }).make_view();
+    };
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 100, 100 };
+    const auto answer = vpk::core::LayoutComputer<Identifier, ValueType>(make_tree()).compute(frame);
+
+    auto layout = vpk::core::LayoutComputer<Identifier, ValueType>(make_tree()).compute_incrementally(frame);
+    int slices = 1;
+    while (!layout.resume(vpk::core::LayoutBudget::node_count(2))) {
+        ASSERT_LT(slices++, 100);
+    }
+    ASSERT_GT(slices, 1);
+    ASSERT_TRUE(layout.finished());
+    ASSERT_EQ(layout.stats().placed_nodes, 10);
+    ASSERT_EQ(layout.result(), answer);
+}
+
+TEST(VpackCoreTest, CancelledLayout) {
+    using Size = vpk::core::Size<ValueType>;
+    using namespace vpkt;
+    const auto tree = HStack{
+        {
+            Text("A", 10).make_view(),
+            VStack{{ Text("B", 40).make_view(), View("C", { 20, 20 }).make_view() }}.make_view(),
+        }
+    }.make_view();
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(tree);
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 200, 200 };
+
+    const auto token = vpk::core::CancellationToken::make();
+    token.cancel();
+    {
+        vpk::core::LayoutContext context;
+        context.set_cancellation_token(token);
+        vpk::core::LayoutContext::Scope scope(context);
+        const auto result = computer.compute(frame);
+        ASSERT_TRUE(context.interrupted());
+        ASSERT_TRUE(result.map.empty());
+    }
+
+    // The cancelled layout must not leave stale measurements behind.
+    const LayoutResult answer{
+        {
+            { "A", {{ 0, 96, 50, 8 }, 0 }},
+            { "B", {{ 50, 82, 150, 16 }, 0 }},
+            { "C", {{ 115, 98, 20, 20 }, 0 }},
+        }, 0
+    };
+    ASSERT_EQ(computer.compute(frame), answer);
+
+    vpk::core::WorkStealingPool pool(2);
+    vpk::core::LayoutJobManager<Identifier, ValueType> manager(tree, &pool);
+    auto stale = manager.submit({ 0, 0, 100, 100 });
+    auto newest = manager.submit(frame);
+    const auto stale_result = stale.get();
+    ASSERT_TRUE(!stale_result.has_value() || stale_result->map.size() == 3);
+    const auto newest_result = newest.get();
+    ASSERT_TRUE(newest_result.has_value());
+    ASSERT_EQ(*newest_result, answer);
+
+    // A failed layout fails its request only.
+    std::atomic<bool> fails = true;
+    const auto failing = std::make_shared<vpk::core::AnyMeasurable<ValueType>>([&fails](const Size& size) {
+        if (fails) throw std::runtime_error("measurement failed");
+        return size;
+    });
+    vpk::core::LayoutJobManager<Identifier, ValueType> failing_manager(with_measurable(Text("F", 10), failing), &pool);
+    ASSERT_THROW(failing_manager.submit(frame).get(), std::runtime_error);
+    fails = false;
+    const auto recovered_result = failing_manager.submit(frame).get();
+    ASSERT_TRUE(recovered_result.has_value());
+    ASSERT_EQ(recovered_result->map.count("F"), 1);
+}
+
+TEST(VpackCoreTest, MeasurePass) {
+    using namespace vpkt;
+    using Size = vpk::core::Size<ValueType>;
+
+    // The content of the measurable changes between two layouts of the same tree.
+    const auto width = std::make_shared<ValueType>(10);
+    const auto measurable = std::make_shared<vpk::core::AnyMeasurable<ValueType>>([width](const Size& size) {
+        return Size{ std::min(*width, size.width), 10 };
+    });
+    const auto tree = HStack{
+        {
+            with_measurable(InfView("A"), measurable),
+            View("B", { 20, 10 }).make_view(),
+        }
+    }.make_view();
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(tree);
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 200, 100 };
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 10);
+    *width = 40;
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 40);
+
+    // A context that retains its measurements reuses them until they are invalidated.
+    vpk::core::LayoutContext context;
+    context.set_retains_measurements(true);
+    vpk::core::LayoutContext::Scope scope(context);
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 40);
+    *width = 25;
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 40);
+    tree->invalidate_measure_cache();
+    ASSERT_EQ(computer.compute(frame).map.at("A").frame.width, 25);
+}
+
+TEST(VpackCoreTest, LegacyElement) {
+    using namespace vpkt;
+    using Layoutable = vpk::core::Layoutable<Identifier, ValueType>;
+
+    // An element written against the interface before `measure_content`, `emit` and `arrange`.
+    struct LegacyBadge : public Layoutable {
+        using Layoutable::Layoutable;
+
+        vpk::core::Size<ValueType> measure(const vpk::core::Size<ValueType>& size) override {
+            return { std::min<ValueType>(size.width, 15), 10 };
+        }
+
+        void layout(const vpk::core::Rect<ValueType>& frame, LayoutResult& result) const override {
+            result.map.insert_or_assign("Badge", vpk::core::LayoutAttributes<ValueType>{ frame, result.max_z_idx });
+        }
+
+        bool places_subtree() const override { return true; }
+    };
+
+    // Overrides that delegate to the default placement after placing their own frames are placed once.
+    struct OutlinedRow : public vpk::core::HorizontalContainer<Identifier, ValueType> {
+        using HorizontalContainer::HorizontalContainer;
+
+        void layout(const vpk::core::Rect<ValueType>& frame, LayoutResult& result) const override {
+            result.map.insert_or_assign("Outline", vpk::core::LayoutAttributes<ValueType>{ frame, result.max_z_idx });
+            HorizontalContainer::layout(frame, result);
+        }
+
+        bool places_subtree() const override { return true; }
+    };
+
+    const auto legacy_root = HStack{
+        {
+            View("A", { 10, 10 }).make_view(),
+            vpk::core::make_layoutable<LegacyBadge>(vpk::core::LayoutParams<ValueType>{}),
+        }
+    }.make_view();
+    const vpk::core::LayoutComputer<Identifier, ValueType> legacy_computer(legacy_root);
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 25, 10 };
+    const LayoutResult legacy_answer{
+        {
+            { "A", {{ 0, 0, 10, 10 }, 0 }},
+            { "Badge", {{ 10, 0, 15, 10 }, 0 }},
+        }, 0
+    };
+    ASSERT_EQ(legacy_computer.compute(frame), legacy_answer);
+    auto incremental = legacy_computer.compute_incrementally(frame);
+    ASSERT_TRUE(incremental.resume());
+    ASSERT_EQ(incremental.result(), legacy_answer);
+    vpk::core::WorkStealingPool pool(2);
+    vpk::core::ParallelPlacementOptions options;
+    options.min_subtree_size = 1;
+    options.min_task_cost = {};
+    ASSERT_EQ(legacy_computer.compute_parallel(frame, &pool, options), legacy_answer);
+
+    const auto outlined_root = vpk::core::make_layoutable<OutlinedRow>(
+        std::vector<vpk::core::LayoutablePointer<Identifier, ValueType>>{
+            View("B", { 10, 10 }).make_view(),
+            legacy_root,
+        },
+        vpk::core::LayoutParams<ValueType>{}, vpk::core::VerticalAlignment::center
+    );
+    const vpk::core::LayoutComputer<Identifier, ValueType> outlined_computer(outlined_root);
+    const vpk::core::Rect<ValueType> outlined_frame{ 0, 0, 35, 10 };
+    const LayoutResult outlined_answer{
+        {
+            { "Outline", {{ 0, 0, 35, 10 }, 0 }},
+            { "B", {{ 0, 0, 10, 10 }, 0 }},
+            { "A", {{ 10, 0, 10, 10 }, 0 }},
+            { "Badge", {{ 20, 0, 15, 10 }, 0 }},
+        }, 0
+    };
+    ASSERT_EQ(outlined_computer.compute(outlined_frame), outlined_answer);
+    auto outlined_incremental = outlined_computer.compute_incrementally(outlined_frame);
+    ASSERT_TRUE(outlined_incremental.resume());
+    ASSERT_EQ(outlined_incremental.result(), outlined_answer);
+    ASSERT_EQ(outlined_computer.compute_parallel(outlined_frame, &pool, options), outlined_answer);
+}
+
+TEST(VpackCoreTest, PipelinedLayout) {
+    using namespace vpkt;
+    const auto make_tree = [] {
+        return HStack{
+            {
+                Text("A", 10).make_view(),
+                Spacer().make_view(),
+                VStack{{ Text("B", 40).make_view(), View("C", { 20, 20 }).make_view() }}.make_view(),
+                ZStack{{ InfView("D").make_view(), Text("E", 3).make_view() }}.make_view(),
+            }
+        }.make_view();
+    };
+
+    vpk::core::WorkStealingPool pool(2);
+    vpk::core::PipelinedLayout<Identifier, ValueType> pipeline(make_tree(), &pool);
+    std::vector<vpk::core::Rect<ValueType>> frames;
+    std::vector<std::future<LayoutResult>> futures;
+    for (int i = 0; i < 8; ++i) {
+        frames.emplace_back(0, 0, 120 + 20 * (i % 3), 200);
+        futures.push_back(pipeline.submit(frames.back()));
+    }
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto answer = vpk::core::LayoutComputer<Identifier, ValueType>(make_tree()).compute(frames[i]);
+        ASSERT_EQ(futures[i].get(), answer);
+    }
+
+    // A failed layout fails its request only, the others are still completed in submission order.
+    const vpk::core::Rect<ValueType> failing_frame{ 0, 0, 20, 200 };
+    const auto failing = std::make_shared<vpk::core::AnyMeasurable<ValueType>>(
+        [failing_frame](const vpk::core::Size<ValueType>& size) {
+            if (size.width == failing_frame.width) throw std::runtime_error("measurement failed");
+            return size;
+        }
+    );
+    vpk::core::PipelinedLayout<Identifier, ValueType> failing_pipeline(with_measurable(Text("F", 10), failing), &pool);
+    auto before = failing_pipeline.submit({ 0, 0, 30, 200 });
+    auto failed = failing_pipeline.submit(failing_frame);
+    auto after = failing_pipeline.submit({ 0, 0, 40, 200 });
+    ASSERT_EQ(before.get().map.count("F"), 1);
+    ASSERT_THROW(failed.get(), std::runtime_error);
+    ASSERT_EQ(after.get().map.count("F"), 1);
+}
+
+TEST(VpackCoreTest, ParallelPlacement) {
+    using namespace vpkt;
+    using Pointer = vpk::core::LayoutablePointer<Identifier, ValueType>;
+    // Builds a tree of alternating stacks, the stacks on the z-axis make the z-indices depend on the placement order.
+    std::size_t next_id = 0;
+    const std::function<Pointer(int)> make_tree = [&](int depth) -> Pointer {
+        if (depth == 0) {
+            const std::size_t id = next_id++;
+            if (id % 2) return Text(std::to_string(id), 5 + static_cast<int>(id % 7)).make_view();
+            return View(std::to_string(id), { 4, 6 }).make_view();
+        }
+        std::vector<Pointer> children;
+        for (int i = 0; i < 4; ++i) children.push_back(make_tree(depth - 1));
+        switch (depth % 3) {
+            case 0: return ZStack{ std::move(children) }.make_view();
+            case 1: return HStack{ std::move(children) }.make_view();
+            default: return VStack{ std::move(children) }.make_view();
+        }
+    };
+    const auto tree = make_tree(5);
+    ASSERT_EQ(tree->subtree_size(), 1365);
+
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(tree);
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 400, 300 };
+    const auto answer = computer.compute(frame);
+    ASSERT_EQ(answer.map.size(), 1024);
+    ASSERT_GT(answer.max_z_idx, 0);
+
+    vpk::core::WorkStealingPool pool(4);
+    const auto compute = [&](const vpk::core::ParallelPlacementOptions& options) {
+        vpk::core::LayoutContext context;
+        vpk::core::LayoutContext::Scope scope(context);
+        EXPECT_EQ(computer.compute_parallel(frame, &pool, options), answer);
+        EXPECT_EQ(context.stats().placed_nodes, 1365);
+        return context.stats().parallel;
+    };
+    vpk::core::ParallelPlacementOptions options;
+    options.min_subtree_size = 1;
+    options.min_task_cost = std::chrono::nanoseconds(0);
+    ASSERT_GT(compute(options).subtree_tasks, 0);
+    ASSERT_GT(tree->placement_cost(), 0);
+
+    // Small siblings are batched until their estimated costs reach the threshold.
+    options.default_element_cost = std::chrono::nanoseconds(1);
+    options.min_task_cost = std::chrono::nanoseconds(30);
+    tree->record_placement_cost(1e6f, 1);
+    for (const auto& child: tree->child_elements()) {
+        child->record_placement_cost(10, 1);
+    }
+    const auto stats = compute(options);
+    ASSERT_GT(stats.batch_tasks, 0);
+    ASSERT_EQ(stats.min_task_cost, options.min_task_cost);
+
+    // A tree that is too cheap to split is placed serially by the calling thread.
+    options.min_task_cost = std::chrono::hours(1);
+    const auto serial_stats = compute(options);
+    ASSERT_EQ(serial_stats.subtree_tasks + serial_stats.batch_tasks, 0);
+    ASSERT_EQ(serial_stats.serial_subtrees, 1);
+
+    ASSERT_EQ(computer.compute_parallel(frame, nullptr), answer);
+}
+
+/// Creates the measurable of a text of the specified length, to replace the measurable of `vpkt::Text`.
+using TextMeasurableFactory = std::function<std::shared_ptr<vpk::core::Measurable<ValueType>>(int length)>;
+
+/// Builds a vertical container of rows of texts, alternately stacked and horizontal, to compare the layout
+/// of texts with custom measurables to the layout of the same texts measured by `vpkt::TextMeasurable`.
+///
+/// \param lengths The lengths of the texts in each row, the texts are identified by their row and column.
+/// \param measurable Creates the measurables of the texts, which keep the measurables of `vpkt::Text` without it.
+vpk::core::LayoutablePointer<Identifier, ValueType>
+make_text_rows(const std::vector<std::vector<int>>& lengths, const TextMeasurableFactory& measurable = {}) {
+    using Pointer = vpk::core::LayoutablePointer<Identifier, ValueType>;
+    std::vector<Pointer> rows;
+    for (std::size_t i = 0; i < lengths.size(); ++i) {
+        std::vector<Pointer> texts;
+        for (std::size_t j = 0; j < lengths[i].size(); ++j) {
+            const vpkt::Text view(std::to_string(i) + "-" + std::to_string(j), lengths[i][j]);
+            texts.push_back(measurable ? vpkt::with_measurable(view, measurable(lengths[i][j])) : view.make_view());
+        }
+        rows.push_back(i % 2 ? vpkt::HStack{ std::move(texts) }.make_view()
+                             : vpkt::ZStack{ std::move(texts) }.make_view());
+    }
+    return vpkt::VStack{ std::move(rows) }.make_view();
+}
+
+TEST(VpackCoreTest, AsyncMeasurable) {
+    using namespace vpkt;
+    using Size = vpk::core::Size<ValueType>;
+
+    // Measures like `Text`, but takes a while on a thread of the pool.
+    struct SlowText : vpk::core::AsyncMeasurable<ValueType> {
+        vpk::core::Executor* executor;
+        int length;
+        std::atomic<int>* in_flight;
+        std::atomic<int>* max_in_flight;
+
+        vpk::core::Task<Size> measure_async(const Size& size) const override {
+            const Size proposed_size = size;
+            co_await vpk::core::resume_on(executor);
+            const int count = in_flight->fetch_add(1) + 1;
+            int max = max_in_flight->load();
+            while (count > max && !max_in_flight->compare_exchange_weak(max, count)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            in_flight->fetch_sub(1);
+            co_return TextMeasurable(length).measure(proposed_size);
+        }
+    };
+
+    std::atomic<int> in_flight{ 0 };
+    std::atomic<int> max_in_flight{ 0 };
+    // Measurements that have been replaced by measurements of other sizes may still be running
+    // when the layout completes, the pool waits for them before the counters are gone.
+    vpk::core::WorkStealingPool pool(4);
+    const auto slow_text = [&](vpk::core::Executor* executor) -> TextMeasurableFactory {
+        return [&, executor](int length) {
+            const auto measurable = std::make_shared<SlowText>();
+            measurable->executor = executor;
+            measurable->length = length;
+            measurable->in_flight = &in_flight;
+            measurable->max_in_flight = &max_in_flight;
+            return measurable;
+        };
+    };
+    const std::vector<std::vector<int>> lengths{{ 10, 20 }, { 4, 40 }};
+
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 120, 200 };
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths, slow_text(&pool)));
+    const auto answer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths)).compute(frame);
+    ASSERT_EQ(computer.compute_async(frame).get(), answer);
+    // The measurements of independent texts overlap.
+    ASSERT_GT(max_in_flight.load(), 1);
+
+    // The task keeps the tree alive after the caller has dropped its pointers to the tree and the computer.
+    auto tree = make_text_rows(lengths, slow_text(&pool));
+    auto task = vpk::core::LayoutComputer<Identifier, ValueType>(tree).compute_async(frame);
+    tree.reset();
+    ASSERT_EQ(task.get(), answer);
+
+    // Without deferring, each measurement is waited for.
+    const vpk::core::Rect<ValueType> narrow_frame{ 0, 0, 90, 200 };
+    const auto narrow_answer =
+        vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths)).compute(narrow_frame);
+    ASSERT_EQ(computer.compute(narrow_frame), narrow_answer);
+
+    // A layout running on the only worker of the pool measures on that worker instead of waiting
+    // for a task queued behind itself.
+    vpk::core::WorkStealingPool single_worker(1);
+    const auto single_answer =
+        vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows({{ 10 }})).compute(frame);
+    vpk::core::LayoutJobManager<Identifier, ValueType> manager(make_text_rows({{ 10 }}, slow_text(&single_worker)),
+                                                               &single_worker);
+    ASSERT_EQ(manager.submit(frame).get(), single_answer);
+    vpk::core::PipelinedLayout<Identifier, ValueType> pipeline(make_text_rows({{ 10 }}, slow_text(&single_worker)),
+                                                               &single_worker);
+    ASSERT_EQ(pipeline.submit(frame).get(), single_answer);
+}
+
+TEST(VpackCoreTest, BatchMeasurable) {
+    using namespace vpkt;
+
+    // Measures like `Text`, and counts the batches.
+    struct TextMeasurer : vpk::core::BatchMeasurer<ValueType> {
+        mutable int batch_count = 0;
+        mutable int measure_count = 0;
+        std::unordered_map<const vpk::core::BatchMeasurable<ValueType>*, int> lengths;
+
+        void measure_batch(std::span<vpk::core::BatchMeasureRequest<ValueType>> requests) const override {
+            batch_count += 1;
+            for (auto& request: requests) {
+                measure_count += 1;
+                request.measured_size = TextMeasurable(lengths.at(request.measurable)).measure(request.proposed_size);
+            }
+        }
+    };
+
+    const auto measurer = std::make_shared<TextMeasurer>();
+    const auto batch_text = [&](int length) {
+        const auto measurable = std::make_shared<vpk::core::BatchMeasurable<ValueType>>(measurer);
+        measurer->lengths[measurable.get()] = length;
+        return measurable;
+    };
+    std::vector<std::vector<int>> lengths(40);
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            lengths[i].push_back(3 + (i * 7 + j * 5) % 17);
+        }
+    }
+
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 160, 2000 };
+    const auto answer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths)).compute(frame);
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths, batch_text));
+    vpk::core::LayoutContext context;
+    vpk::core::LayoutContext::Scope scope(context);
+    ASSERT_EQ(computer.compute(frame), answer);
+    ASSERT_GT(context.stats().batched_nodes, 0);
+    // Most labels are measured in batches instead of one at a time.
+    ASSERT_LT(measurer->batch_count, measurer->measure_count / 2);
+}
+
+TEST(VpackCoreTest, SharedMeasureCache) {
+    using namespace vpkt;
+    using Pointer = vpk::core::LayoutablePointer<Identifier, ValueType>;
+    using Size = vpk::core::Size<ValueType>;
+
+    // Measures like `Text`, texts of the same length share their measurements.
+    struct KeyedText : TextMeasurable {
+        KeyedText(int length, std::shared_ptr<std::atomic<int>> measure_count)
+            : TextMeasurable(length), length(length), measure_count(std::move(measure_count)) {}
+
+        int length;
+        std::shared_ptr<std::atomic<int>> measure_count;
+
+        vpk::core::Measurement<ValueType> measure_with_validity(const Size& size) const override {
+            measure_count->fetch_add(1);
+            return TextMeasurable::measure_with_validity(size);
+        }
+
+        vpk::optional<std::size_t> content_key() const override { return length; }
+    };
+
+    const auto measure_count = std::make_shared<std::atomic<int>>(0);
+    const auto keyed_text = [&](int length) { return std::make_shared<KeyedText>(length, measure_count); };
+    std::vector<std::vector<int>> lengths(1);
+    for (int i = 0; i < 100; ++i) {
+        lengths[0].push_back(10 + i % 4);
+    }
+
+    auto& cache = vpk::core::SharedMeasureCache<ValueType>::global();
+    cache.clear();
+    cache.reset_stats();
+    const vpk::core::Rect<ValueType> frame{ 0, 0, 30, 2000 };
+    const auto compute = [&frame](const Pointer& tree) {
+        return vpk::core::LayoutComputer<Identifier, ValueType>(tree).compute(frame);
+    };
+    const auto answer = compute(make_text_rows(lengths));
+    ASSERT_EQ(compute(make_text_rows(lengths, keyed_text)), answer);
+    // Every length is measured once per proposed size, also by another tree.
+    const int first_count = measure_count->load();
+    ASSERT_LE(first_count, 8);
+    ASSERT_EQ(compute(make_text_rows(lengths, keyed_text)), answer);
+    ASSERT_EQ(measure_count->load(), first_count);
+    ASSERT_GT(cache.stats().hit_rate(), 0.5);
+
+    // The least recently used measurements are evicted when the capacity is exceeded.
+    vpk::core::SharedMeasureCache<ValueType> small_cache(
+        vpk::core::SharedMeasureCache<ValueType>::entry_size * 16 * 2
+    );
+    for (std::size_t key = 0; key < 200; ++key) {
+        small_cache.insert(key, { 10, 10 }, { 1, 1 });
+    }
+    const auto stats = small_cache.stats();
+    ASSERT_LE(stats.entries, 32);
+    ASSERT_EQ(stats.evictions, 200 - stats.entries);
+    ASSERT_TRUE(small_cache.find(199, { 10, 10 }).has_value());
+    ASSERT_FALSE(small_cache.find(199, { 10, 11 }).has_value());
+    cache.clear();
+}
+
+TEST(VpackCoreTest, MeasureValidity) {
+    using namespace vpkt;
+    using Size = vpk::core::Size<ValueType>;
+
+    struct CountingText : TextMeasurable {
+        using TextMeasurable::TextMeasurable;
+
+        mutable int measure_count = 0;
+
+        vpk::core::Measurement<ValueType> measure_with_validity(const Size& size) const override {
+            measure_count += 1;
+            return TextMeasurable::measure_with_validity(size);
+        }
+    };
+
+    const auto text = CountingText(30);
+    ASSERT_TRUE(text.measure_with_validity({ 52, 100 }).holds_for({ 54.5, 3 }));
+    ASSERT_FALSE(text.measure_with_validity({ 52, 100 }).holds_for({ 55, 100 }));
+
+    std::vector<std::shared_ptr<CountingText>> measurables;
+    const auto counting_text = [&measurables](int length) {
+        return measurables.emplace_back(std::make_shared<CountingText>(length));
+    };
+    const std::vector<std::vector<int>> lengths{{ 20 }, { 30 }, { 40 }};
+
+    const auto computer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths, counting_text));
+    int frame_count = 0;
+    // Drag the width of the window over a few line breaks, the texts do not change in the meantime.
+    vpk::core::LayoutContext context;
+    context.set_retains_measurements(true);
+    vpk::core::LayoutContext::Scope scope(context);
+    for (ValueType width = 60; width < 80; width += 0.25) {
+        const vpk::core::Rect<ValueType> frame{ 0, 0, width, 400 };
+        const auto answer = vpk::core::LayoutComputer<Identifier, ValueType>(make_text_rows(lengths)).compute(frame);
+        ASSERT_EQ(computer.compute(frame), answer);
+        frame_count += 1;
+    }
+    for (const auto& measurable: measurables) {
+        // Each text is only measured again when its lines break differently.
+        ASSERT_LE(measurable->measure_count, 8);
+    }
+    ASSERT_EQ(frame_count, 80);
+}
+
+TEST(VpackCoreTest, Executor) {
+    // Sums a range by splitting it recursively, which waits inside tasks of the same pool.
+    const std::function<long(vpk::core::Executor*, long, long)> sum = [&sum](
+        vpk::core::Executor* executor, long begin, long end
+    ) -> long {
+        if (end - begin <= 16) {
+            long result = 0;
+            for (long i = begin; i < end; ++i) result += i;
+            return result;
+        }
+        const long middle = begin + (end - begin) / 2;
+        long left = 0;
+        long right = 0;
+        vpk::core::TaskGroup group(executor);
+        group.run([&] { left = sum(executor, begin, middle); });
+        group.run([&] { right = sum(executor, middle, end); });
+        group.wait();
+        return left + right;
+    };
+
+    vpk::core::WorkStealingPool pool(4);
+    ASSERT_EQ(sum(&pool, 0, 10000), 49995000);
+    ASSERT_EQ(sum(nullptr, 0, 10000), 49995000);
+
+    std::vector<std::function<void()>> queue;
+    vpk::core::ExecutorAdapter adapter([&queue](std::function<void()> task) { queue.push_back(std::move(task)); }, 1);
+    // Tasks that the adapted executor has not started are run by the waiting thread.
+    ASSERT_EQ(sum(&adapter, 0, 100), 4950);
+}
+
+TEST(VpackCoreTest, ResizableLayout) {
+    using namespace vpkt;
+    using Computer = vpk::core::LayoutComputer<Identifier, ValueType>;
+    using Rect = vpk::core::Rect<ValueType>;
+
+    const auto make_tree = [] {
+        return VStack{
+            {
+                HStack{
+                    {
+                        DStack(
+                            {
+                                InfView("Background").make_view(),
+                                Text("Title", 10).padding({ 12, 6, 12, 6 }).make_view(),
+                            }, vpk::core::DecoratedStyle::background
+                        ).make_view(),
+                        Spacer().make_view(),
+                        View("Button", { 40, 20 }).make_view(),
+                    }
+                }.make_view(),
+                Text("Description", 30).make_view(),
+                ZStack{
+                    {
+                        View("Image", { 60, 30 }).make_view(),
+                        Text("Caption", 6).make_view(),
+                    }
+                }.make_view(),
+            }
+        }.alignment(vpk::core::HorizontalAlignment::leading).make_view();
+    };
+
+    const Rect frame{ 0, 0, 200, 150 };
+    const auto layout = Computer(make_tree()).compute_resizable(frame);
+    ASSERT_EQ(layout.result(), Computer(make_tree()).compute(frame));
+    // The description keeps its single line down to its width.
+    ASSERT_EQ(layout.validity().width, (vpk::core::Range<ValueType>{ 150, std::numeric_limits<ValueType>::infinity() }));
+    ASSERT_TRUE(layout.validity().height.contains(150));
+
+    int update_count = 0;
+    for (const ValueType width: { 150.0, 151.5, 175.0, 200.0, 260.0, 400.0 }) {
+        for (const ValueType height: { 120.0, 144.0, 150.0, 200.0, 320.0, 509.0, 600.0 }) {
+            const Rect resized_frame{ 0, 0, width, height };
+            if (!layout.holds_for(resized_frame)) continue;
+            ASSERT_EQ(layout.update(resized_frame), Computer(make_tree()).compute(resized_frame));
+            update_count += 1;
+        }
+    }
+    ASSERT_EQ(update_count, 30);
+    ASSERT_FALSE(layout.holds_for({ 0, 0, 149, 150 }));
+}
+
+TEST(VpackCoreTest, ParametricLayout) {
+    using namespace vpkt;
+    using Computer = vpk::core::LayoutComputer<Identifier, ValueType>;
+
+    const auto make_tree = [] {
+        return VStack{
+            {
+                HStack{
+                    {
+                        Text("Title", 10).make_view(),
+                        Spacer().make_view(),
+                        View("Button", { 40, 20 }).make_view(),
+                    }
+                }.make_view(),
+                Text("Description", 30).make_view(),
+            }
+        }.make_view();
+    };
+
+    const auto layout = Computer(make_tree()).compute_parametric({ 60, 300 }, 200);
+    ASSERT_EQ(layout.widths(), (vpk::core::Range<ValueType>{ 60, 300 }));
+    // The structure only changes when the description breaks into lines differently.
+    const auto breakpoints = layout.breakpoints();
+    ASSERT_EQ(breakpoints.size(), 18);
+    ASSERT_EQ(breakpoints.front(), 65);
+    ASSERT_EQ(breakpoints.back(), 150);
+    for (ValueType width = 60; width < 300; width += 2.5) {
+        ASSERT_EQ(layout.evaluate(width), Computer(make_tree()).compute({ 0, 0, width, 200 }));
+    }
+
+    const auto limited_layout = Computer(make_tree()).compute_parametric({ 60, 300 }, 200, 4);
+    ASSERT_EQ(limited_layout.widths(), (vpk::core::Range<ValueType>{ 60, 80 }));
+    ASSERT_FALSE(limited_layout.covers(80));
+}
+
+TEST(VpackCoreTest, LayoutProgram) {
+    using namespace vpkt;
+    using Item = vpk::core::Item<Identifier, ValueType>;
+
+    const auto make_text = [](std::string id, int priority) -> vpk::core::LayoutablePointer<Identifier, ValueType> {
+        auto params = Text(std::string(id), 10).make_view()->params();
+        params.priority = priority;
+        return vpk::core::make_layoutable<Item>(std::move(id), params, std::make_shared<TextMeasurable>(10));
+    };
+    const auto root = VStack{
+        {
+            HStack{
+                {
+                    make_text("A", 0),
+                    View("B", { 20, 30 }).padding({ 2, 4, 6, 8 }).offset({ 3, -1 }).make_view(),
+                    make_text("C", 1),
+                    Spacer().make_view(),
+                }
+            }.alignment(vpk::core::VerticalAlignment::bottom).padding({ 5, 5, 5, 5 }).make_view(),
+            ZStack{
+                {
+                    View("D", { 40, 40 }).make_view(),
+                    VStack{
+                        {
+                            Text("E", 25).make_view(),
+                            View("F", { 15, 10 }).padding({ 1, 2, 3, 4 }).make_view(),
+                        }
+                    }.alignment(vpk::core::HorizontalAlignment::trailing).make_view(),
+                }
+            }.alignment(vpk::core::Alignment::bottom_leading).make_view(),
+            DStack{
+                {
+                    View("G", { 30, 20 }).make_view(),
+                    ZStack{{ View("H", { 5, 5 }).make_view() }}.make_view(),
+                }, vpk::core::DecoratedStyle::overlay
+            }.make_view(),
+        }
+    }.alignment(vpk::core::HorizontalAlignment::leading).make_view();
+
+    vpk::core::LayoutProgram<Identifier, ValueType> program(root);
+    // The decorated container is kept as a single opaque node.
+    ASSERT_EQ(program.node_count(), 12);
+    const vpk::core::LayoutComputer<Identifier, ValueType> computer(root);
+    // The program keeps its working memory, running it again must not depend on the previous run.
+    for (const auto& frame: std::vector<vpk::core::Rect<ValueType>>{
+        { 0, 0, 200, 300 }, { 10, 20, 60, 90 }, { 0, 0, 200, 300 }
+    }) {
+        const auto result = program.run(frame);
+        ASSERT_EQ(result.map.size(), 8);
+        ASSERT_EQ(result, computer.compute(frame));
+    }
+}
+
+TEST(VpackCoreTest, NodeKind) {
+    using namespace vpkt;
+    using vpk::core::detail::NodeKind;
+    using Item = vpk::core::Item<Identifier, ValueType>;
+
+    // A subclass of an element type of the library keeps its overrides, it is dispatched as a custom element.
+    struct ShiftedItem : public Item {
+        using Item::Item;
+
+        void emit(const vpk::core::Rect<ValueType>& frame, LayoutResult& result) const override {
+            Item::emit({ frame.x + 1, frame.y, frame.width, frame.height }, result);
+        }
+    };
+
+    const auto shifted = vpk::core::make_layoutable<ShiftedItem>(
+        "B", View("B", { 10, 10 }).make_view()->params(),
+        std::make_shared<vpk::core::AnyMeasurable<ValueType>>(vpk::core::Size<ValueType>{ 10, 10 })
+    );
+    const auto root = HStack{
+        {
+            View("A", { 10, 10 }).make_view(),
+            shifted,
+            ZStack{{ View("C", { 10, 10 }).make_view() }}.make_view(),
+        }
+    }.make_view();
+    const vpk::core::LayoutComputer<Identifier, ValueType> computer(root);
+
+    ASSERT_EQ(root->node_kind(), NodeKind::horizontal);
+    ASSERT_EQ(root->child_elements()[0]->node_kind(), NodeKind::item);
+    ASSERT_EQ(root->child_elements()[1]->node_kind(), NodeKind::custom);
+    ASSERT_EQ(root->child_elements()[2]->node_kind(), NodeKind::stack);
+
+    const auto result = computer.compute({ 0, 0, 30, 10 });
+    ASSERT_EQ(result.map.at("A").frame, (vpk::core::Rect<ValueType>{ 0, 0, 10, 10 }));
+    ASSERT_EQ(result.map.at("B").frame, (vpk::core::Rect<ValueType>{ 11, 0, 10, 10 }));
+    ASSERT_EQ(result.map.at("C").frame, (vpk::core::Rect<ValueType>{ 20, 0, 10, 10 }));
+}
+
+/// Lays out the same tree of items with the value type, to compare the layouts of different value types.
+///
+/// A vertical container holds two items, one of them without a maximum width, and a row of items of three priorities
+/// that divide the width of the row among them.
+template<typename V>
+vpk::core::LayoutResult<Identifier, V> compute_item_tree(int row_length, const vpk::core::Rect<V>& frame) {
+    using Element = vpk::core::LayoutablePointer<Identifier, V>;
+    const auto make_item = [](Identifier id, V min_width, V max_width, int priority = 0) -> Element {
+        const vpk::core::LayoutParams<V> params{ { min_width, V(10), max_width, V(10) }, { 1, 2, 1, 2 }, {}, priority };
+        return vpk::core::make_layoutable<vpk::core::Item<Identifier, V>>(
+            std::move(id), params, std::make_shared<vpk::core::AnyMeasurable<V>>()
+        );
+    };
+    std::vector<Element> row;
+    for (int i = 0; i < row_length; ++i) {
+        row.push_back(make_item("R" + std::to_string(i), 2, V(4 + i), i % 3));
+    }
+    std::vector<Element> children{
+        make_item("A", 10, 40),
+        make_item("B", 0, std::numeric_limits<V>::infinity(), 1),
+        vpk::core::make_layoutable<vpk::core::HorizontalContainer<Identifier, V>>(
+            std::move(row), vpk::core::LayoutParams<V>{}, vpk::core::VerticalAlignment::top
+        ),
+    };
+    const auto root = vpk::core::make_layoutable<vpk::core::VerticalContainer<Identifier, V>>(
+        std::move(children), vpk::core::LayoutParams<V>{}, vpk::core::HorizontalAlignment::leading
+    );
+    return vpk::core::LayoutComputer<Identifier, V>(root).compute(frame);
+}
+
+/// Asserts that the layout has the frames and the z-indices of the layout with `double`s.
+template<typename V>
+void assert_same_layout(const vpk::core::LayoutResult<Identifier, V>& result, const LayoutResult& answer) {
+    ASSERT_EQ(result.map.size(), answer.map.size());
+    for (const auto& [id, attributes]: answer.map) {
+        const vpk::core::Rect<ValueType>& frame = attributes.frame;
+        const vpk::core::Rect<V> converted_frame{ V(frame.x), V(frame.y), V(frame.width), V(frame.height) };
+        ASSERT_EQ(result.map.at(id).frame, converted_frame) << id;
+        ASSERT_EQ(result.map.at(id).z_idx, attributes.z_idx) << id;
+    }
+}
+
+TEST(VpackCoreTest, FloatValueType) {
+    const LayoutResult answer = compute_item_tree<double>(10, { 0, 0, 120, 200 });
+    ASSERT_EQ(answer.map.size(), 12);
+    assert_same_layout(compute_item_tree<float>(10, { 0, 0, 120, 200 }), answer);
+
+    // Equal infinities are equal, e.g. the sizes of unlimited elements.
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    ASSERT_TRUE(vpk::core::detail::almost_equal(infinity, infinity));
+    ASSERT_FALSE(vpk::core::detail::almost_equal(infinity, std::numeric_limits<float>::max()));
+    float value = infinity;
+    ASSERT_TRUE(vpk::is_infinity(value));
+
+    // The reductions cover the lanes and the remainder.
+    std::vector<float> values(19);
+    std::iota(values.begin(), values.end(), 1.f);
+    ASSERT_EQ(vpk::reduce_sum<float>(values), 190);
+    ASSERT_EQ(vpk::reduce_max<float>(values, 0), 19);
+    ASSERT_EQ(vpk::reduce_max<float>(values, 42), 42);
+    ASSERT_EQ(vpk::reduce_sum<double>(std::vector<double>{ 1, 2, 3, infinity }), infinity);
+}
+
+TEST(VpackCoreTest, FixedPoint) {
+    using Fixed = vpk::core::FixedPoint<>;
+    using Limits = std::numeric_limits<Fixed>;
+
+    // The arithmetic saturates to the infinities and rounds toward negative infinity.
+    ASSERT_EQ(Fixed(8388607) + 1, Limits::infinity());
+    ASSERT_EQ(Limits::infinity() - 100, Limits::infinity());
+    ASSERT_EQ(-Limits::infinity() + Limits::infinity(), 0);
+    ASSERT_EQ(Fixed::from_raw(-3) / 2, Fixed::from_raw(-2));
+    ASSERT_EQ(Fixed::from_raw(3) / 2, Fixed::from_raw(1));
+    ASSERT_EQ(Fixed(2.5) * Fixed(-1.5), Fixed(-3.75));
+    ASSERT_EQ(Fixed(10) / 3, Fixed::from_raw(853));
+    ASSERT_FALSE(vpk::core::CompactOptional<Fixed>().has_value());
+
+    const LayoutResult answer = compute_item_tree<double>(3, { 0, 0, 121, 49 });
+    ASSERT_EQ(answer.map.size(), 5);
+    assert_same_layout(compute_item_tree<Fixed>(3, { 0, 0, 121, 49 }), answer);
+}
+
+TEST(VpackCoreTest, PixelSnapping) {
+    using Element = vpk::core::LayoutablePointer<Identifier, ValueType>;
+    const auto make_item = [](Identifier id, ValueType width) -> Element {
+        const vpk::core::LayoutParams<ValueType> params{ { width, 10.3, width, 10.3 }, {}, {}, 0 };
+        return vpk::core::make_layoutable<vpk::core::Item<Identifier, ValueType>>(
+            std::move(id), params, std::make_shared<vpk::core::AnyMeasurable<ValueType>>()
+        );
+    };
+    std::vector<Element> children{ make_item("A", 10.3), make_item("B", 10.3), make_item("C", 10.4) };
+    const auto root = vpk::core::make_layoutable<vpk::core::HorizontalContainer<Identifier, ValueType>>(
+        std::move(children), vpk::core::LayoutParams<ValueType>{}, vpk::core::VerticalAlignment::center
+    );
+    const auto layout = vpk::core::LayoutComputer<Identifier, ValueType>(root).compute({ 0.25, 0.25, 31, 12 });
+
+    for (const ValueType scale: { 1.0, 1.5, 2.0, 3.0 }) {
+        auto result = layout;
+        vpk::core::snap_to_pixels(result, scale);
+        const auto& a = result.map.at("A").frame;
+        const auto& b = result.map.at("B").frame;
+        const auto& c = result.map.at("C").frame;
+        // The siblings stay adjacent and every edge lies on a device pixel.
+        ASSERT_EQ(a.max_x(), b.x) << scale;
+        ASSERT_EQ(b.max_x(), c.x) << scale;
+        for (const auto& [id, attributes]: result.map) {
+            const auto& frame = attributes.frame;
+            for (const ValueType edge: { frame.x, frame.y, frame.max_x(), frame.max_y() }) {
+                ASSERT_DOUBLE_EQ(edge * scale, std::nearbyint(edge * scale)) << id << " " << scale;
+            }
+        }
+    }
+
+    // Two `float` frames per vector and a scalar tail, the halves round to even.
+    std::vector<vpk::core::Rect<float>> frames{
+        { 0.25f, 0.75f, 1.5f, 1.0f }, { 1.75f, 0.75f, 1.5f, 1.0f }, { 3.25f, 0.75f, 1.5f, 1.0f },
+    };
+    vpk::core::snap_to_pixels<float>(frames, 2.0f);
+    ASSERT_EQ(frames[0], (vpk::core::Rect<float>{ 0, 1, 2, 1 }));
+    ASSERT_EQ(frames[1], (vpk::core::Rect<float>{ 2, 1, 1, 1 }));
+    ASSERT_EQ(frames[2], (vpk::core::Rect<float>{ 3, 1, 2, 1 }));
+}